@@ -1,31 +1,154 @@
 #ifndef AUXILIARY_H
 #define AUXILIARY_H
 
+#include <stdatomic.h>
 #include "tasks.h"
+#include "kernel.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Maximum number of offsets held by a job lattice (the lattice covers the largest bound with at most this many HI criticality job deadlines)
+#ifndef JOB_LATTICE_MAX_OFFSETS
+#define JOB_LATTICE_MAX_OFFSETS 4096
+#endif
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Arithmetic progression {t - kTi - Di | k >= 0} of the s points contributed by a single HI criticality task, in increasing order
+typedef struct {
+    long long int next;                  // Smallest s point of the progression not yet merged, i.e. (t - Di) mod Ti initially
+    long long int last;                  // Largest s point of the progression, i.e. t - Di
+    int period;                          // Common difference of the progression, i.e. Ti
+} SPointsCursor;
+
+// Job lattice: sorted HI criticality job deadlines {kTi + Di | k >= 0} of a taskset up to a bound, without duplicates. S(t) \ {t} is
+// {t - o | o <= t} over the offsets o of the lattice, so for any t <= bound it is read from the lattice instead of being merged.
+// The lattice only depends on the periods and deadlines of the HI criticality tasks, not on their wcets
+typedef struct {
+    long long int *offsets;              // Offsets in increasing order
+    int num_offsets;                     // Number of offsets
+    long long int bound;                 // All offsets <= bound are present (LLONG_MAX if the taskset has no HI criticality task)
+} JobLattice;
+
+// Sorted S(t) generator: k-way merge of the HI criticality task progressions using a min-heap keyed on the next s point,
+// or a backward scan of a job lattice
+typedef struct {
+    SPointsCursor *heap;                 // Min-heap of progressions (capacity: number of tasks, provided by the caller)
+    int heap_size;                       // Number of progressions that are not exhausted yet
+    long long int t;                     // Interval length t, the largest element of S(t)
+    long long int last_s_point;          // Last s point returned, used to skip duplicates
+    long long int num_returned;          // Number of s points returned so far
+    int t_returned;                      // Set to 1 once t has been returned
+    const long long int *offsets;        // Offsets of the job lattice (NULL --> S(t) is merged from the heap)
+    int num_offsets;                     // Number of lattice offsets <= t not returned yet
+} SPointsIterator;
+
+// Scratch memory of the schedulability tests. A workspace is owned by a single caller (e.g. one per thread) and is reused
+// across tasksets, so that the tests themselves keep no state and never modify the taskset they analyse
+typedef struct {
+    long long int *s_points;             // s points chunk
+    int s_points_capacity;               // Number of s points the chunk can hold
+    SPointsCursor *s_points_heap;        // Heap storage of the S(t) generator
+    int heap_capacity;                   // Number of progressions the heap can hold
+    atomic_int *cancel;                  // Set to 1 by another thread to abandon the running test (NULL --> the test is never cancelled)
+    const JobLattice *lattice;           // Job lattice of the analysed taskset, set by the caller (NULL --> S(t) is always merged)
+    DemandKernel kernel;                 // Processor demand kernel of MC-QPA
+} Workspace;
 
 // =====================
 // FUNCTION DECLARATIONS
 // =====================
 
-// Get the number of jobs arriving and having deadlines within the given interval
-int get_num_jobs (long long int interval, int deadline, int period);
+// Get the processor demand sum of DBFi(t, s) over all tasks for the given (t, s) values (0 <= s <= t)
+double get_processor_demand (const Tasks *tasks, int num_tasks, long long int t, long long int s);
+
+// Initialize a sorted S(t) generator for the given t. The heap array must hold at least num_tasks cursors
+void init_s_points_iterator (SPointsIterator *iterator, SPointsCursor *heap, const Tasks *tasks, int num_tasks, long long int t);
+
+// Initialize a sorted S(t) generator for the given t from a job lattice. Return 1 on success, 0 if t exceeds the lattice bound
+int init_s_points_iterator_cached (SPointsIterator *iterator, const JobLattice *lattice, long long int t);
+
+// Store the next s point of S(t) (increasing order, without duplicates) in s_point. Return 1 on success, 0 once S(t) is exhausted
+int next_s_point (SPointsIterator *iterator, long long int *s_point);
+
+// Store the next (at most max_s_points) s points of S(t) in the s_points chunk. Return the number of s points stored, 0 once S(t) is exhausted
+int get_s_points (SPointsIterator *iterator, long long int *s_points, int max_s_points);
+
+// Get the largest step point <= t of the maximum processor demand over S(t), i.e. the largest t' <= t such that the demand is constant on [t', t]
+// (0 if t is below all deadlines). The heap array must hold at least num_tasks cursors
+long long int get_step_point (const Tasks *tasks, int num_tasks, SPointsCursor *heap, long long int t);
 
-// Quick sort comparator function
-int sort_comparator (const void * a, const void * b);
+// Initialize an empty job lattice
+void init_job_lattice (JobLattice *lattice);
 
-// Determine S(t) for t = floor(B), store all the s points in s_arr array. Return array size
-int get_s_points (Tasks *tasks, int num_tasks, long long int *s_points, long long int floor_t_upper_bound);
+// Build the job lattice of the HI criticality tasks of a taskset, covering the largest bound with at most max_offsets job deadlines.
+// A lattice may be used for any taskset with the same HI criticality (period, deadline) pairs (a superset of pairs only adds s points)
+void build_job_lattice (JobLattice *lattice, const Tasks *tasks, int num_tasks, int max_offsets);
 
-// Utility function to remove duplicate array elements and return new array size
-int sort_deduplicate_s_points(long long int *s_points, int num_s_points);
+// Release the memory held by the job lattice
+void free_job_lattice (JobLattice *lattice);
+
+// Initialize an empty workspace
+void init_workspace (Workspace *workspace);
+
+// Grow the workspace (if needed) to hold max_s_points s points, the S(t) generator and the demand kernel of num_tasks tasks.
+// Return 1 on success, 0 if out of memory
+int reserve_workspace (Workspace *workspace, int max_s_points, int num_tasks);
+
+// Return 1 if the test using the workspace has been cancelled by another thread, else 0
+int test_cancelled (const Workspace *workspace);
+
+// Release the memory held by the workspace
+void free_workspace (Workspace *workspace);
 
 // Utility function to calculate total taskset utilization
-double get_taskset_utilization (Tasks *tasks, int num_tasks);
+double get_taskset_utilization (const Tasks *tasks, int num_tasks);
+
+// =======================
+// INLINE HELPER FUNCTIONS
+// =======================
+
+// The helpers are static inline so that libmcqpa does not export their generic names to the programs it is linked into
+
+// Get the number of jobs arriving and having deadlines within the given interval
+static inline long long int get_num_jobs (long long int interval, int deadline, int period) {
+
+    // If interval < deadline, no job has its deadline within the given interval
+    if (interval < deadline)
+        return 0;
+
+    // Calculate the number of jobs arriving and having deadlines within the given interval (64-bit integer arithmetic, exact for any interval)
+    return (interval - deadline) / period + 1;
+}
+
+// Quick sort comparator function for long long int arrays
+// Compares instead of subtracting: the difference of two 64-bit values does not fit in the int return value
+static inline int sort_comparator (const void * a, const void * b) {
+
+    long long int x = *(const long long int *)a;
+    long long int y = *(const long long int *)b;
+
+    return (x > y) - (x < y);
+}
 
 // Utility function to find the minimum of two numbers
-int min (int a, int b);
+static inline long long int min (long long int a, long long int b) {
+    if (a <= b)
+        return a;
+    else
+        return b;
+}
 
 // Utility function to find the maximum of two numbers
-double max (double a, double b);
+static inline double max (double a, double b) {
+    if (a >= b)
+        return a;
+    else
+        return b;
+}
 
 #endif
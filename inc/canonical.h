@@ -0,0 +1,25 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include "tasks.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Canonicalization comparison (input methods 't' and 'f'): 1 --> MC-QPA is also run on every taskset as given, and its test time and pair-points
+// are reported next to those on the canonical taskset, 0 --> only the canonical taskset is analysed (default). May be overridden at compile time (-DCANONICAL_COMPARE=1)
+#ifndef CANONICAL_COMPARE
+#define CANONICAL_COMPARE 0
+#endif
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Canonicalize a taskset before analysis: drop the tasks whose wcets are all zero, merge the tasks with identical (period, deadline, criticality)
+// into a single task with the summed wcets and utilizations, and order the tasks by criticality, period and deadline. The canonical taskset
+// (at most num_tasks tasks) has the same processor demand at every (t, s) point, hence the same verdict. Return the number of canonical tasks
+int canonicalize_taskset (const Tasks *tasks, int num_tasks, Tasks *canonical_tasks);
+
+#endif
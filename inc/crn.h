@@ -0,0 +1,52 @@
+#ifndef CRN_H
+#define CRN_H
+
+#include "tasks.h"
+#include "auxiliary.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Common random numbers sweep (input method 't'): 1 --> the k-th taskset of every utilization level of a criticality proportion is rescaled
+// from the same k-th base taskset, 0 --> every taskset is drawn afresh (original behaviour). May be overridden at compile time (-DSWEEP_CRN=1)
+#ifndef SWEEP_CRN
+#define SWEEP_CRN 0
+#endif
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Base taskset and the structure shared by all its rescaled versions
+typedef struct {
+    Tasks *tasks;                        // Base taskset (LO criticality utilizations summing up to 1.0)
+    Tasks *canonical_tasks;              // Canonical form of the base taskset (canonicalization commutes with rescaling)
+    int num_canonical_tasks;             // Number of tasks in the canonical base taskset
+    JobLattice lattice;                  // Job lattice of the HI criticality tasks (independent of the utilization)
+} BaseTaskset;
+
+// Base tasksets of a criticality proportion, generated on demand and kept for all utilization levels
+typedef struct {
+    BaseTaskset *bases;                  // Base tasksets, in generation order
+    int num_bases;                       // Number of base tasksets generated
+    int capacity;                        // Number of base tasksets the array can hold
+    int num_tasks;                       // Number of tasks per taskset
+    double criticality_proportion;       // Criticality proportion of the base tasksets
+    long long int num_offsets;           // Total number of job lattice offsets (memory held by the lattices)
+} BaseTasksetPool;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize an empty pool of base tasksets with the given number of tasks and criticality proportion
+void init_base_taskset_pool (BaseTasksetPool *pool, int num_tasks, double criticality_proportion);
+
+// Get the k-th base taskset of the pool, generating (and canonicalizing, and building the job lattice of) the missing ones
+const BaseTaskset* get_base_taskset (BaseTasksetPool *pool, int k);
+
+// Release the memory held by the pool
+void free_base_taskset_pool (BaseTasksetPool *pool);
+
+#endif
@@ -46,6 +46,13 @@ void calculate_task_wcets (Tasks *tasks, int num_tasks) ;
 // Task parameter generator driver function
 Tasks* task_parameter_generator (Tasks *tasks, int num_tasks, double total_util, double criticality_proportion);
 
+// Base taskset generator (common random numbers): criticalities, periods, deadlines and criticality factors as task_parameter_generator,
+// with LO criticality utilizations summing up to 1.0 (the UUnifast utilization vector scales linearly with the total utilization)
+Tasks* base_taskset_generator (Tasks *tasks, int num_tasks, double criticality_proportion);
+
+// Rescale the wcets and utilizations of a base taskset to the given total LO criticality utilization (all other parameters are copied)
+Tasks* scale_taskset (const Tasks *base_tasks, int num_tasks, double total_utilization, Tasks *tasks);
+
 // Fetch task parameters as input from file and stores it in the task structure array
 void fetch_task_parameters ( FILE* input_file, Tasks *tasks, int num_tasks);
 
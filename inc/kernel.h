@@ -0,0 +1,75 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "tasks.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Processor demand kernels: evaluation of sum of DBFi(t, s) over all tasks at the s points of a given t
+#define KERNEL_AUTO -1                   // Selected at dispatch time: KERNEL_ALL_LO, KERNEL_ALL_HI, else KERNEL_PARTITIONED (fastest in the kernel benchmark)
+#define KERNEL_GENERIC 0                 // Loop over all tasks, branching on the criticality of each task (fallback of all other kernels)
+#define KERNEL_PARTITIONED 1             // psi_i(t) terms summed once per t, separate LO / HI criticality task loops for the s-dependent terms
+#define KERNEL_ALL_LO 2                  // No HI criticality task: S(t) = {t} and the demand is sum of psi_i(t) * Ci(LO) (classical QPA)
+#define KERNEL_ALL_HI 3                  // No LO criticality task: only the HI criticality task loop
+#define NUM_KERNELS 4
+
+// Kernel used by MC-QPA (may be overridden at compile time, e.g. -DMCQPA_KERNEL=KERNEL_GENERIC)
+#ifndef MCQPA_KERNEL
+#define MCQPA_KERNEL KERNEL_AUTO
+#endif
+
+// Kernel benchmark parameters (input method 'k')
+#define KERNEL_BENCH_NUM_TASKSETS 50     // Number of tasksets per benchmark cell
+#define KERNEL_BENCH_NUM_SIZES 4         // Number of taskset sizes benchmarked
+#define KERNEL_BENCH_SIZES {8, 16, 20, 32}
+#define KERNEL_BENCH_NUM_PROPORTIONS 3   // Number of criticality proportions benchmarked
+#define KERNEL_BENCH_PROPORTIONS {0.00, 0.50, 1.00}
+#define KERNEL_BENCH_UTILIZATIONS {0.80, 0.50, 0.30}    // LO criticality utilization of the generated tasksets for each criticality proportion (Ci(HI) <= 4 Ci(LO))
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Processor demand kernel, set up once per taskset and once per t. The tasks whose DBF does not depend on s (Ci(LO) = Ci(HI)) only
+// contribute to the base demand; the others are stored as structures of arrays, one per criticality level
+typedef struct DemandKernel {
+    int variant;                         // Kernel variant in use (KERNEL_GENERIC ... KERNEL_ALL_HI)
+    double (*get_demand) (const struct DemandKernel *kernel, long long int s);    // Processor demand at (t, s) for the current t
+    const Tasks *tasks;                  // Taskset
+    int num_tasks;                       // Number of tasks
+    long long int t;                     // Current t
+    double base_demand;                  // Part of the demand that does not depend on s at the current t
+    int num_lo;                          // Number of LO criticality tasks with Ci(LO) != Ci(HI)
+    int num_hi;                          // Number of HI criticality tasks with Ci(HI) != Ci(LO)
+    long long int *lo_period;            // LO criticality tasks: Ti
+    long long int *lo_deadline;          // LO criticality tasks: Di
+    long long int *lo_num_jobs;          // LO criticality tasks: psi_i(t) at the current t
+    double *lo_delta;                    // LO criticality tasks: Ci(LO) - Ci(HI)
+    long long int *hi_period;            // HI criticality tasks: Ti
+    long long int *hi_deadline;          // HI criticality tasks: Di
+    double *hi_delta;                    // HI criticality tasks: Ci(HI) - Ci(LO)
+    int capacity;                        // Number of tasks the arrays can hold
+} DemandKernel;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize an empty kernel
+void init_demand_kernel (DemandKernel *kernel);
+
+// Grow the task arrays of the kernel (if needed) to hold num_tasks tasks. Return 1 on success, 0 if out of memory (the kernel is left empty)
+int reserve_demand_kernel (DemandKernel *kernel, int num_tasks);
+
+// Set the kernel up for the given taskset. A variant that does not apply to the taskset falls back on KERNEL_GENERIC. Return the variant in use
+int setup_demand_kernel (DemandKernel *kernel, const Tasks *tasks, int num_tasks, int variant);
+
+// Set the current t of the kernel (computes the s-independent part of the demand)
+void set_demand_kernel_t (DemandKernel *kernel, long long int t);
+
+// Release the memory held by the kernel
+void free_demand_kernel (DemandKernel *kernel);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// HDR-style histogram: values below 2^HISTOGRAM_SUB_BUCKET_BITS are recorded exactly, larger values in 2^(HISTOGRAM_SUB_BUCKET_BITS - 1)
+// logarithmically spaced sub-buckets per power of two, i.e. with a relative error below 2^-(HISTOGRAM_SUB_BUCKET_BITS - 1) (1.6%)
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_NUM_BUCKETS ((64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * (HISTOGRAM_SUB_BUCKET_COUNT / 2) + HISTOGRAM_SUB_BUCKET_COUNT / 2)
+
+// Number of slowest tasksets (per algorithm and sweep cell) whose parameters are reported
+#define SLOWEST_TASKSETS 3
+
+// Output file listing the slowest tasksets of every sweep cell
+#define SLOWEST_FILE "slowest.csv"
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Latency histogram (values in nanoseconds)
+typedef struct {
+    long long int counts[HISTOGRAM_NUM_BUCKETS];    // Number of values recorded in each bucket
+    long long int total_count;                      // Number of values recorded
+    long long int max_value;                        // Largest value recorded (exact)
+} Histogram;
+
+// Slow taskset record: latency and the taskset shape that caused it
+typedef struct {
+    long long int latency;               // CPU time taken by the test (ns)
+    long double interval_length;         // floor(B)
+    long long int t_points;              // Number of t points checked
+    long long int t_s_points;            // Number of (t, s) points checked
+} SlowTaskset;
+
+// Latency statistics of a schedulability test over a set of tasksets (e.g. a sweep cell)
+typedef struct {
+    Histogram histogram;                          // Per-taskset latency distribution
+    SlowTaskset slowest[SLOWEST_TASKSETS];        // Slowest tasksets, in decreasing latency order
+    int num_slowest;                              // Number of valid entries in slowest
+} LatencyStats;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// CPU time consumed by the calling thread, in nanoseconds
+long long int get_cpu_time_ns (void);
+
+// Monotonic wall-clock time, in nanoseconds (for runs spread over several threads, e.g. portfolio execution)
+long long int get_wall_time_ns (void);
+
+// Reset the latency statistics
+void init_latency_stats (LatencyStats *latency_stats);
+
+// Record the latency of a test run on a single taskset, along with the test results
+void record_latency (LatencyStats *latency_stats, long long int latency, const Schedulability *schedulability);
+
+// Get the value at the given percentile (0.0 - 100.0) of the recorded latencies (ns), 0 if none was recorded
+long long int get_latency_percentile (const LatencyStats *latency_stats, double percentile);
+
+#endif
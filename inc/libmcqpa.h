@@ -0,0 +1,105 @@
+#ifndef LIBMCQPA_H
+#define LIBMCQPA_H
+
+// libmcqpa: Reentrant C API of the schedulability tests for in-process embedding (e.g. admission controllers)
+//
+//  - A context (McqpaContext) holds the scratch memory of the tests. It must not be shared by concurrent callers:
+//    create one context per thread, and reuse it across calls so that warm calls perform no allocation.
+//  - A taskset (McqpaTaskset) is immutable once created. The tests never modify it, so the same taskset may be
+//    analysed by any number of threads at once, each with its own context.
+//  - The library has no global state.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Exported symbols (all the other symbols of the shared library are hidden)
+#define MCQPA_API __attribute__((visibility("default")))
+
+// Return values of the API functions
+#define MCQPA_OK 0
+#define MCQPA_EINVAL -1                  // Invalid argument
+#define MCQPA_ENOMEM -2                  // Out of memory
+
+// Task criticality levels
+#define MCQPA_LO 0
+#define MCQPA_HI 1
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Opaque analysis context (scratch memory of the tests)
+typedef struct McqpaContext McqpaContext;
+
+// Opaque, immutable taskset handle
+typedef struct McqpaTaskset McqpaTaskset;
+
+// Schedulability test selection
+typedef enum {
+    MCQPA_TEST_ITERATIVE = 0,            // Iterative: exact test scanning all t in [1, floor(B)] --> Algorithm 1 in the paper
+    MCQPA_TEST_MCQPA = 1,                // MC-QPA: exact test descending from floor(B) --> Algorithm 2 in the paper
+    MCQPA_TEST_APPROX = 2,               // Approximate: demand with linear job count envelopes beyond k jobs, MC-QPA when inconclusive
+    MCQPA_TEST_MCQPA_SNAP = 3            // MC-QPA visiting the step points of the processor demand only (DESCENT_SNAP)
+} McqpaTest;
+
+// Task parameters, as in the input file
+typedef struct {
+    int period;                          // Minimum inter-arrival time (positive integer)
+    int deadline;                        // Relative deadline (positive integer)
+    int criticality;                     // MCQPA_LO or MCQPA_HI
+    double wcet_lo;                      // Worst-case execution time at LO criticality level
+    double wcet_hi;                      // Worst-case execution time at HI criticality level
+} McqpaTaskParams;
+
+// Analysis result
+typedef struct {
+    int schedulable;                     // 1 if the taskset is EDF schedulable, else 0
+    long double interval_length;         // floor(B), the interval length considered for demand bound function analysis
+    long long int t_points;              // Number of t points for which the demand bound function was calculated
+    long long int t_s_points;            // Number of (t, s) points for which the demand bound function was calculated
+    long long int peak_memory;           // Peak scratch memory (in bytes) used by the test for this taskset
+} McqpaResult;
+
+// Violation witness: a (t, s) point at which the processor demand exceeds t (t = 0 --> no witness)
+typedef struct {
+    long long int t;                     // Interval length t
+    long long int s;                     // s value (0 <= s <= t)
+    double demand;                       // Processor demand at (t, s)
+} McqpaWitness;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Create an analysis context. Return NULL if out of memory
+MCQPA_API McqpaContext* mcqpa_context_create (void);
+
+// Release an analysis context
+MCQPA_API void mcqpa_context_destroy (McqpaContext *context);
+
+// Create an immutable taskset from num_tasks task parameters (the parameters are copied). Return NULL on invalid parameters / out of memory
+MCQPA_API McqpaTaskset* mcqpa_taskset_create (const McqpaTaskParams *params, int num_tasks);
+
+// Release a taskset
+MCQPA_API void mcqpa_taskset_destroy (McqpaTaskset *taskset);
+
+// Number of tasks in the taskset
+MCQPA_API int mcqpa_taskset_size (const McqpaTaskset *taskset);
+
+// Analyse the taskset with the selected test, using the context's scratch memory. Return MCQPA_OK, MCQPA_EINVAL or MCQPA_ENOMEM
+MCQPA_API int mcqpa_analyze (McqpaContext *context, const McqpaTaskset *taskset, McqpaTest test, McqpaResult *result);
+
+// Analyse the taskset with MC-QPA, checking the num_candidates candidate witnesses (e.g. returned for a similar taskset) first.
+// If witness is not NULL, it receives the violation witness of a NOT schedulable taskset (t = 0 if none). Return MCQPA_OK, MCQPA_EINVAL or MCQPA_ENOMEM
+MCQPA_API int mcqpa_analyze_witnesses (McqpaContext *context, const McqpaTaskset *taskset, const McqpaWitness *candidates, int num_candidates, McqpaResult *result, McqpaWitness *witness);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
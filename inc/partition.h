@@ -0,0 +1,87 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <stdio.h>
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Partitioning heuristics: core on which the next task is placed, among the cores on which it is schedulable
+#define PARTITION_FIRST_FIT 0            // Lowest-index core
+#define PARTITION_BEST_FIT 1             // Most loaded core (max{U_LO, U_HI} of the core)
+#define PARTITION_WORST_FIT 2            // Least loaded core
+#define NUM_PARTITION_HEURISTICS 3
+
+// Task orders: tasks are placed by decreasing
+#define PARTITION_ORDER_U_HI 0           // Ui(HI)
+#define PARTITION_ORDER_U_LO 1           // Ui(LO)
+#define PARTITION_ORDER_DENSITY 2        // max{Ci(LO), Ci(HI)} / min{Di, Ti}
+#define NUM_PARTITION_ORDERS 3
+
+// Number of violation witnesses kept per core (rejected placements on the core, checked first for the next tasks)
+#ifndef PARTITION_CORE_WITNESSES
+#define PARTITION_CORE_WITNESSES 8
+#endif
+
+// Partitioning sweep parameters (input method 'p'): tasksets of (tasks per core * cores) tasks, with a total utilization of
+// PARTITION_CORE_UTILIZATION per core
+#define PARTITION_NUM_TASKSETS 10        // Number of tasksets per sweep cell
+#define PARTITION_SWEEP_NUM_CORES 3      // Number of core counts swept
+#define PARTITION_SWEEP_CORES {2, 4, 8}
+#define PARTITION_SWEEP_NUM_SIZES 2      // Number of taskset sizes swept
+#define PARTITION_SWEEP_TASKS_PER_CORE {5, 10}
+#define PARTITION_CORE_UTILIZATION 0.60
+#define PARTITION_CRITICALITY_PROPORTION 0.50
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Analysis state of a core, updated incrementally as tasks are placed on it
+typedef struct {
+    Tasks *tasks;                                     // Tasks placed on the core, with room for one candidate task
+    int num_tasks;                                    // Number of tasks placed on the core
+    double utilization[2];                            // U_LO and U_HI of the core
+    double density;                                   // Sum of max{Ci(LO), Ci(HI)} / min{Di, Ti} over the tasks of the core
+    Witness witnesses[PARTITION_CORE_WITNESSES];      // Violation witnesses of rejected placements (demand: processor demand of the core's tasks)
+    int num_witnesses;                                // Number of valid witnesses
+    int next_witness;                                 // Witness overwritten next once all are valid
+} Core;
+
+// Partitioning state: cores, placement of the tasks, and statistics of the last partitioning
+typedef struct {
+    Core *cores;                         // Cores
+    int max_cores;                       // Number of available cores
+    int num_cores;                       // Number of cores used
+    int max_tasks;                       // Maximum number of tasks of a taskset
+    int *assignment;                     // Core of each task (input order), -1 if the task is not placed
+    int *task_order;                     // Task indices in placement order
+    double *keys;                        // Sort key of each task
+    int *core_order;                     // Core indices in probing order
+    Workspace workspace;                 // Scratch memory of the exact test, kept warm across placements
+    long long int placement_attempts;    // Number of (task, core) pairs considered, i.e. the exact tests run by a black-box partitioning
+    long long int utilization_rejections;    // Placements rejected by Max{U_HI, U_LO} < 1.0
+    long long int witness_rejections;    // Placements rejected by a violation witness of the core
+    long long int density_acceptances;   // Placements accepted by the density bound
+    long long int oracle_calls;          // Placements decided by the exact test (MC-QPA)
+} Partition;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize the partitioning state for tasksets of up to max_tasks tasks on up to max_cores cores
+void init_partition (Partition *partition, int max_tasks, int max_cores);
+
+// Partition the taskset with the given heuristic and task order (decreasing). Return the number of cores used, 0 if some task cannot be placed
+int partition_taskset (Partition *partition, const Tasks *tasks, int num_tasks, int heuristic, int order);
+
+// Release the partitioning state
+void free_partition (Partition *partition);
+
+// Partitioning sweep (input method 'p'): cores needed, exact test calls and packing throughput of every heuristic and task order, as n and m grow
+void run_partition_sweep (FILE *output_fptr);
+
+#endif
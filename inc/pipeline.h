@@ -0,0 +1,173 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "tasks.h"
+#include "auxiliary.h"
+#include "schedtest.h"
+#include "crn.h"
+#include "profile.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Capacity of each queue between two stages (power of 2). A full queue blocks its producer (backpressure)
+#ifndef PIPELINE_QUEUE_SIZE
+#define PIPELINE_QUEUE_SIZE 64
+#endif
+
+// Number of exact-test worker threads (0 --> number of online processors, at most PIPELINE_MAX_WORKERS). Each worker keeps its own workspace,
+// portfolio (and its helper thread, PORTFOLIO), verification decisions and witness pool, so that with more than one worker the Iterative
+// cross-checks and witness hits are decided per worker. Defaults to 1, so that the results do not depend on the host
+#ifndef PIPELINE_NUM_WORKERS
+#define PIPELINE_NUM_WORKERS 1
+#endif
+
+#define PIPELINE_MAX_WORKERS 64          // Maximum number of exact-test worker threads
+
+// Reorder window of the aggregator: the generator never runs more than PIPELINE_REORDER_SIZE tasksets ahead of the next taskset to aggregate,
+// whichever path (workers or prefilter) and however slow the tasksets in flight are
+#ifndef PIPELINE_REORDER_SIZE
+#define PIPELINE_REORDER_SIZE (4 * PIPELINE_QUEUE_SIZE)
+#endif
+
+// Backoff of a stage waiting on an empty input queue or a full output queue
+#ifndef PIPELINE_SPIN_LIMIT
+#define PIPELINE_SPIN_LIMIT 64           // Number of sched_yield calls before sleeping
+#endif
+
+#ifndef PIPELINE_MAX_SLEEP_NS
+#define PIPELINE_MAX_SLEEP_NS 100000     // Longest sleep (ns), the sleep doubles from 1 us up to this value
+#endif
+
+// Pipeline stages
+#define PIPELINE_GENERATE 0              // Taskset generator (input method 't') or input file reader (input method 'f')
+#define PIPELINE_PREFILTER 1             // Canonicalization, taskset utilization, Max{U_HI, U_LO} < 1.0 check
+#define PIPELINE_ANALYZE 2               // Exact-test workers
+#define PIPELINE_AGGREGATE 3             // Aggregator and output writer (calling thread)
+#define PIPELINE_NUM_STAGES 4
+
+// Names of the pipeline stages, in stage order
+#define PIPELINE_STAGE_NAMES {"Generate", "Prefilter", "Analyze", "Aggregate"}
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Slot of a bounded queue: the sequence number tells producers and consumers whose turn it is
+typedef struct {
+    atomic_size_t sequence;              // Position + 1 once filled, position + capacity once consumed
+    void *item;                          // Queued item
+} QueueSlot;
+
+// Bounded lock-free multi-producer multi-consumer queue (array of slots with per-slot sequence numbers), also used for single-producer
+// single-consumer links. Producers and consumers only contend on their own position counter
+typedef struct {
+    QueueSlot *slots;                    // Ring of slots
+    size_t mask;                         // Capacity - 1
+    _Alignas(64) atomic_size_t enqueue_position;
+    _Alignas(64) atomic_size_t dequeue_position;
+} BoundedQueue;
+
+// Time spent by the threads of a stage (ns): the busy time is the rest of the wall-clock time
+typedef struct {
+    long long int start;                 // Wall-clock time at which the stage started
+    long long int end;                   // Wall-clock time at which the stage finished (0 --> still running)
+    long long int starved;               // Time spent waiting on an empty input queue
+    long long int blocked;               // Time spent waiting on a full output queue (backpressure)
+    long long int num_items;             // Number of tasksets handled
+} StageStats;
+
+// Taskset travelling through the pipeline, with the results of every test
+typedef struct {
+    long long int sequence;              // Generation order (the aggregator consumes tasksets in this order)
+    int cell;                            // Sweep cell (input method 't'), 0 for input method 'f'
+    int end;                             // Set to 1 for the end-of-stream marker
+    int discarded;                       // Set to 1 if the cell already had enough tasksets when the taskset reached a worker (not analysed)
+    int prefiltered;                     // Set to 1 if the prefilter decided the taskset (Max{U_HI, U_LO} >= 1.0, not analysed by the workers)
+    Tasks *tasks;                        // Taskset as generated / read
+    int num_tasks;                       // Number of tasks in the taskset
+    Tasks *canonical_tasks;              // Canonical taskset analysed by the tests
+    int num_canonical_tasks;             // Number of tasks in the canonical taskset (-1 --> not canonicalized yet)
+    JobLattice lattice;                  // Job lattice of the base taskset (SWEEP_CRN), owned by the base taskset pool
+    int has_lattice;                     // Set to 1 if lattice is valid
+    double taskset_util;                 // Taskset utilization
+    Schedulability schedulability;       // Iterative test result (zero points if not verified)
+    Schedulability schedulability_mcqpa; // MC-QPA result (witness-first for input method 'f')
+    Schedulability schedulability_approx; // Approximate test result (APPROX_TEST)
+    Schedulability schedulability_portfolio; // Portfolio result (PORTFOLIO)
+    Schedulability schedulability_raw;   // MC-QPA on the taskset as given (CANONICAL_COMPARE)
+    long long int t1, t2, t3, t4, t5;    // CPU time (ns) of Iterative / MC-QPA / Approximate, wall-clock time (ns) of the portfolio, CPU time (ns) of MC-QPA (raw)
+    int verified;                        // Set to 1 if the Iterative test cross-checked the taskset
+    int winner;                          // Test that gave the portfolio verdict
+    long long int profile_counts[PROFILE_NUM_COUNTERS];           // Performance counters of the Iterative test (PROFILING)
+    long long int profile_counts_mcqpa[PROFILE_NUM_COUNTERS];     // Performance counters of MC-QPA (PROFILING)
+} PipelineItem;
+
+// Staged analysis pipeline: generator / reader --> prefilter --> exact-test workers --> aggregator (calling thread)
+typedef struct {
+    char mode;                                    // Input method ('t' or 'f')
+    FILE *input_file;                             // Input file, positioned after the number of tasksets (input method 'f')
+    int num_tasksets;                             // Number of tasksets in the input file (input method 'f')
+    unsigned int verification_seed;               // Seed of the verification decisions of the workers
+    BoundedQueue generated;                       // Generator --> prefilter
+    BoundedQueue prefiltered;                     // Prefilter --> workers
+    BoundedQueue analysed;                        // Workers and prefilter --> aggregator
+    atomic_int cells_done;                        // Number of sweep cells that have enough tasksets (set by the aggregator)
+    pthread_t generator;
+    pthread_t prefilter;
+    pthread_t workers[PIPELINE_MAX_WORKERS];
+    int num_workers;                              // Number of exact-test worker threads
+    atomic_int next_worker;                       // Index of the next worker thread to start
+    StageStats stage_stats[PIPELINE_NUM_STAGES];  // Stage times (generator, prefilter, aggregator)
+    StageStats worker_stats[PIPELINE_MAX_WORKERS];
+    BaseTasksetPool *base_pools;                  // Base tasksets of every criticality proportion (SWEEP_CRN), kept until the pipeline is freed
+    int num_base_pools;                           // Number of base taskset pools
+    long long int num_base_tasksets;              // Number of base tasksets generated (set by free_pipeline)
+    long long int num_offsets;                    // Number of job lattice offsets stored (set by free_pipeline)
+    PipelineItem *pending[PIPELINE_REORDER_SIZE]; // Tasksets received out of order by the aggregator, indexed by sequence
+    atomic_llong next_sequence;                   // Sequence of the next taskset to aggregate (read by the generator)
+    int num_ended;                                // Number of workers whose end-of-stream marker the aggregator received
+    long long int num_discarded;                  // Number of tasksets generated beyond the needs of their cell
+    long long int num_prefiltered;                // Number of tasksets decided by the prefilter
+} Pipeline;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize an empty bounded queue with the given capacity (power of 2)
+void init_bounded_queue (BoundedQueue *queue, size_t capacity);
+
+// Append an item to the queue. Return 1 on success, 0 if the queue is full
+int try_push_item (BoundedQueue *queue, void *item);
+
+// Remove the oldest item from the queue. Return 1 on success, 0 if the queue is empty
+int try_pop_item (BoundedQueue *queue, void **item);
+
+// Release the memory held by the queue
+void free_bounded_queue (BoundedQueue *queue);
+
+// Start the pipeline threads for the given input method ('t': generated sweep, 'f': input file with num_tasksets tasksets)
+void init_pipeline (Pipeline *pipeline, char mode, FILE *input_file, int num_tasksets, unsigned int verification_seed);
+
+// Get the next analysed taskset, in generation order (aggregator). Tasksets of cells that already have enough tasksets are skipped
+PipelineItem* next_pipeline_item (Pipeline *pipeline, int cell);
+
+// Tell the generator that the given sweep cell has enough tasksets (aggregator)
+void finish_pipeline_cell (Pipeline *pipeline, int cell);
+
+// Release a taskset handed over by next_pipeline_item
+void free_pipeline_item (PipelineItem *item);
+
+// Write the time, item count and utilization of every stage to the output file and the terminal (after free_pipeline)
+void print_pipeline_stats (Pipeline *pipeline, FILE *output_fptr);
+
+// Drain the pipeline, join its threads and release it
+void free_pipeline (Pipeline *pipeline);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Portfolio execution (input methods 't' and 'f'): 1 --> every taskset is also analysed by the portfolio, and its test time, latency and wins
+// are reported, 0 --> the portfolio is not run (default). May be overridden at compile time (-DPORTFOLIO=1)
+#ifndef PORTFOLIO
+#define PORTFOLIO 0
+#endif
+
+// Exact tests raced by the portfolio (index of their result, also returned as the winner)
+#define PORTFOLIO_ITERATIVE 0            // Iterative, run by the helper thread (fastest when the violation is at a small t)
+#define PORTFOLIO_MCQPA 1                // MC-QPA, run by the calling thread (fastest on SCHEDULABLE tasksets)
+#define PORTFOLIO_NUM_TESTS 2
+
+// States of the helper thread
+#define PORTFOLIO_IDLE 0                 // Waiting for a taskset
+#define PORTFOLIO_RUNNING 1              // Running Iterative on the current taskset
+#define PORTFOLIO_DONE 2                 // Iterative finished (or was cancelled) on the current taskset
+#define PORTFOLIO_EXIT 3                 // Asked to terminate
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Portfolio of exact tests racing on the same taskset: the first verdict is kept and the other test is cancelled.
+// The helper thread is started once and reused for every taskset, each test keeping its own warm workspace
+typedef struct {
+    pthread_t helper;                                 // Helper thread running Iterative
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;                           // Signalled whenever state changes
+    int state;                                        // One of the PORTFOLIO_* states of the helper thread
+    const Tasks *tasks;                               // Taskset under analysis (only read by both tests)
+    int num_tasks;                                    // Number of tasks in the taskset
+    Schedulability results[PORTFOLIO_NUM_TESTS];      // Result of each test (CANCELLED for the loser)
+    Workspace workspaces[PORTFOLIO_NUM_TESTS];        // Scratch memory of each test
+    atomic_int cancel[PORTFOLIO_NUM_TESTS];           // Cancel flag of each test, set by the winner
+    atomic_int winner;                                // Index of the first test to reach a verdict (-1 --> none yet)
+} Portfolio;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize the portfolio and start its helper thread
+void init_portfolio (Portfolio *portfolio);
+
+// Race Iterative and MC-QPA on the given taskset, store the verdict of the first one to finish in schedulability and return
+// its index (PORTFOLIO_ITERATIVE or PORTFOLIO_MCQPA)
+int schedulability_test_portfolio (Portfolio *portfolio, const Tasks *tasks, int num_tasks, Schedulability *schedulability);
+
+// Stop the helper thread and release the portfolio
+void free_portfolio (Portfolio *portfolio);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Profiling mode (input method 't'): 1 --> every Iterative and MC-QPA call is wrapped in performance counters, aggregated per sweep cell
+// in PROFILE_FILE. May be overridden at compile time (-DPROFILING=1)
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+
+// Output file listing the performance counters of every sweep cell
+#define PROFILE_FILE "profile.csv"
+
+// Performance counters (Linux perf_event_open, user space only)
+#define PROFILE_CYCLES 0                 // CPU cycles
+#define PROFILE_INSTRUCTIONS 1           // Retired instructions
+#define PROFILE_BRANCH_MISSES 2          // Mispredicted branches
+#define PROFILE_L1D_MISSES 3             // L1 data cache read misses
+#define PROFILE_LLC_MISSES 4             // Last level cache misses
+#define PROFILE_TASK_CLOCK 5             // CPU time (ns): software perf event, or the thread CPU clock if perf_event_open is unavailable
+#define PROFILE_NUM_COUNTERS 6
+
+// Names of the performance counters, in counter order
+#define PROFILE_COUNTER_NAMES {"Cycles", "Instructions", "Branch misses", "L1D misses", "LLC misses", "Task clock (ns)"}
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Performance counters of the calling thread
+typedef struct {
+    int fds[PROFILE_NUM_COUNTERS];                // perf event file descriptors (-1 --> counter not available)
+    long long int start_cpu_time;                 // Thread CPU time at start_profiler (task clock fallback)
+} Profiler;
+
+// Performance counters of a schedulability test aggregated over a set of tasksets (e.g. a sweep cell)
+typedef struct {
+    long long int counts[PROFILE_NUM_COUNTERS];   // Sum of each counter over the tasksets (-1 --> counter not available)
+    int num_tasksets;                             // Number of tasksets profiled
+    long long int t_points;                       // Total number of t points checked
+    long long int t_s_points;                     // Total number of (t, s) points checked
+} ProfileStats;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Open the performance counters of the calling thread; the counters that the kernel or the hardware does not provide are left unavailable
+void init_profiler (Profiler *profiler);
+
+// Return 1 if the counter is available, else 0
+int profiler_counter_available (const Profiler *profiler, int counter);
+
+// Reset and start the counters
+void start_profiler (Profiler *profiler);
+
+// Stop the counters and store their values since start_profiler in counts (-1 for unavailable counters)
+void stop_profiler (Profiler *profiler, long long int counts[PROFILE_NUM_COUNTERS]);
+
+// Close the performance counters
+void free_profiler (Profiler *profiler);
+
+// Reset the aggregated counters
+void init_profile_stats (ProfileStats *profile_stats);
+
+// Add the counters of a test call on a taskset, with the t and (t, s) points it checked
+void add_profile_sample (ProfileStats *profile_stats, const long long int counts[PROFILE_NUM_COUNTERS], const Schedulability *schedulability);
+
+// Write the column headings of the profile file
+void print_profile_header (FILE *profile_fptr);
+
+// Append a line of aggregated counters (totals, per t point and per (t, s) point, n/a if unavailable) to the profile file
+void print_profile_stats (FILE *profile_fptr, double criticality_proportion, double taskset_utilization, const char *algorithm, const ProfileStats *profile_stats);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Sampling policies: number of tasksets generated per sweep cell (input method 't')
+#define SAMPLING_FIXED 0                 // Exactly NUM_TASKSETS tasksets per cell (original behaviour)
+#define SAMPLING_ADAPTIVE 1              // Sequential sampling: stop once the weighted schedulability confidence interval is narrow enough
+
+// Selected sampling policy and its parameters (may be overridden at compile time, e.g. -DSAMPLING_POLICY=SAMPLING_ADAPTIVE)
+#ifndef SAMPLING_POLICY
+#define SAMPLING_POLICY SAMPLING_FIXED
+#endif
+
+#ifndef SAMPLING_CI_WIDTH
+#define SAMPLING_CI_WIDTH 0.10           // Target width of the weighted schedulability confidence interval
+#endif
+
+#ifndef SAMPLING_Z
+#define SAMPLING_Z 1.96                  // Standard normal quantile of the confidence level (1.96 --> 95%)
+#endif
+
+#ifndef SAMPLING_MIN_TASKSETS
+#define SAMPLING_MIN_TASKSETS 30         // Minimum number of tasksets per cell (the interval is unreliable on fewer samples)
+#endif
+
+#ifndef SAMPLING_MAX_TASKSETS
+#define SAMPLING_MAX_TASKSETS 1000       // Maximum number of tasksets per cell
+#endif
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Running sums of a sweep cell. Weighted schedulability is the ratio estimator R = sum(ui * xi) / sum(ui) over the tasksets,
+// with ui the taskset utilization and xi = 1 if the taskset is SCHEDULABLE, else 0
+typedef struct {
+    int policy;                          // One of the SAMPLING_* policies
+    int num_samples;                     // Number of tasksets
+    double sum_u;                        // sum(ui)
+    double sum_ux;                       // sum(ui * xi)
+    double sum_u2;                       // sum(ui^2)
+    double sum_u2x;                      // sum(ui^2 * xi)
+} Sampling;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize the running sums of a sweep cell with the compile-time selected policy
+void init_sampling (Sampling *sampling);
+
+// Add a taskset with the given utilization and schedulability (1 --> SCHEDULABLE) to the running sums
+void add_sample (Sampling *sampling, double taskset_utilization, int schedulable);
+
+// Get the half-width of the weighted schedulability confidence interval (delta method, rule of three if all verdicts agree), 1.0 on fewer than 2 samples
+double get_ci_half_width (const Sampling *sampling);
+
+// Get the largest number of tasksets the sweep cell may need
+int get_max_samples (const Sampling *sampling);
+
+// Return 1 if the sweep cell needs more tasksets, else 0
+int sampling_required (const Sampling *sampling);
+
+#endif
@@ -2,6 +2,7 @@
 #define SCHEDTEST_H
 
 #include "tasks.h"
+#include "auxiliary.h"
 
 // =================
 // MACRO DEFINITIONS
@@ -11,11 +12,52 @@
 #define DEFAULT -1
 #define SCHEDULABLE 1
 #define NOT_SCHEDULABLE 0
+#define CANCELLED -2                     // The test was cancelled through its workspace before reaching a verdict
+#define OUT_OF_MEMORY -3                 // The test could not allocate its scratch memory
+
+// Maximum number of s points of S(t) held in memory at once. S(t) is streamed in chunks of this size,
+// so that the memory needed by the tests does not grow with B
+#ifndef S_POINTS_CHUNK_SIZE
+#define S_POINTS_CHUNK_SIZE 4096
+#endif
+
+// Descent strategies of MC-QPA: next t point after a t point at which the maximum processor demand h(t) does not exceed t
+#define DESCENT_STEP 0                   // t = floor(h(t)) if h(t) < t, else t - 1 (Algorithm 2)
+#define DESCENT_SNAP 1                   // Same, snapped down to the nearest step point of h (the demand is constant in between)
+#define NUM_DESCENT_STRATEGIES 2
+
+// Names of the descent strategies, in strategy order
+#define DESCENT_NAMES {"Step", "Snap"}
+
+// Descent strategy used by schedulability_test_mcqpa
+#ifndef MCQPA_DESCENT
+#define MCQPA_DESCENT DESCENT_STEP
+#endif
+
+// Approximate test (input methods 't' and 'f'): 1 --> every taskset is also analysed by the approximate test, and its test time, latency and
+// fallback rate are reported, 0 --> the approximate test is not run (default). May be overridden at compile time (-DAPPROX_TEST=1)
+#ifndef APPROX_TEST
+#define APPROX_TEST 0
+#endif
+
+// Accuracy of the approximate test: the job counts of DBFi(t, s) are exact for the first k = ceil(1 / APPROX_EPSILON) jobs of each task
+// and bounded by their linear envelope beyond, which overestimates the demand by a factor of at most 1 + APPROX_EPSILON. The number of
+// (t, s) points checked depends on n and APPROX_EPSILON but not on B
+#ifndef APPROX_EPSILON
+#define APPROX_EPSILON 0.10
+#endif
 
 // =============================
 // ABSTRACT DATATYPE DEFINITIONS
 // =============================
 
+// Violation witness: a (t, s) point at which the processor demand exceeds t, which proves that a taskset is NOT_SCHEDULABLE
+typedef struct {
+    long long int t;                     // Interval length t (0 --> no witness)
+    long long int s;                     // s value (0 <= s <= t)
+    double demand;                       // Sum of DBFi(t, s) over all tasks (> t)
+} Witness;
+
 // Schedulability information structure
 typedef struct {
     int taskset_schedulability;          // Boolean variable set to SCHEDULABLE (i.e. 1) if taskset is schedulable, else NOT_SCHEDULABLE (i.e. 0)
@@ -24,16 +66,38 @@ typedef struct {
     long double interval_length;         // Total interval length that is considered for demand bound function analysis of the given taskset
     int failed_case1;                    // Boolean variable set to 1 if the schedulability test failure happens at t < 0.5B, else 0
     int failed_case2;                    // Boolean variable set to 1 if the schedulability test failure happens at t < 0.25B, else 0
+    long long int peak_memory;           // Peak memory (in bytes) allocated by the test for the given taskset
+    int approx_fallback;                 // Boolean variable set to 1 if the approximate test was inconclusive and fell back on MC-QPA, else 0
+    Witness witness;                     // (t, s) point at which the test failed (t = 0 if SCHEDULABLE or if the taskset fails Max{U_HI, U_LO} < 1.0)
+    int witness_hit;                     // Boolean variable set to 1 if one of the candidate witnesses rejected the taskset, else 0
+    int kernel;                          // Processor demand kernel used by MC-QPA (KERNEL_GENERIC for the other tests)
+    long long int cached_t_points;       // Number of t points whose S(t) was read from the workspace's job lattice (MC-QPA only)
 } Schedulability;
 
 // =====================
 // FUNCTION DECLARATIONS
 // =====================
 
+// All tests are reentrant: they only read the taskset and keep their scratch memory in the given workspace
+// (NULL --> a temporary workspace is allocated and released within the call). Setting the workspace's cancel flag from another thread
+// makes the running test return CANCELLED at its next t point
+
 // Iterative: Exact EDF schedulability test for 3-parameter sporadic task systems [3] --> Listed as Algorithm 1 in the paper
-Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability *schedulability);
+Schedulability* schedulability_test (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace);
 
 // MC-QPA (based on QPA [4]): A more efficient exact EDF schedulability test for 3-parameter sporadic task systems --> Listed as Algorithm 2 in the paper
-Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedulability *schedulability);
+Schedulability* schedulability_test_mcqpa (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace);
+
+// MC-QPA with the given descent strategy (DESCENT_STEP or DESCENT_SNAP), all strategies give the same verdict
+Schedulability* schedulability_test_mcqpa_descent (const Tasks *tasks, int num_tasks, int descent_strategy, Schedulability *schedulability, Workspace *workspace);
+
+// MC-QPA with the given descent strategy and processor demand kernel (KERNEL_AUTO, or one of the variants in kernel.h), all kernels give the same verdict
+Schedulability* schedulability_test_mcqpa_kernel (const Tasks *tasks, int num_tasks, int descent_strategy, int kernel, Schedulability *schedulability, Workspace *workspace);
+
+// Approximate: Sufficient test on the demand overestimated by at most (1 + APPROX_EPSILON) [5], falling back on MC-QPA when inconclusive (exact overall)
+Schedulability* schedulability_test_approx (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace);
+
+// Witness-first MC-QPA: checks the candidate witnesses (e.g. returned for a similar taskset) in O(n * num_witnesses) before the full MC-QPA descent
+Schedulability* schedulability_test_witness (const Tasks *tasks, int num_tasks, const Witness *witnesses, int num_witnesses, Schedulability *schedulability, Workspace *workspace);
 
 #endif
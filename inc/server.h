@@ -0,0 +1,94 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <pthread.h>
+#include "libmcqpa.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Server parameters
+#define SERVER_NUM_WORKERS 0             // Number of analysis worker threads (0 --> number of online processors)
+#define SERVER_QUEUE_SIZE 1024           // Maximum number of pending requests, connections block when the queue is full
+#define SERVER_BATCH_SIZE 32             // Maximum number of requests coalesced into a single batch by a worker
+#define SERVER_LISTEN_BACKLOG 64         // Maximum number of pending connections on the socket
+#define SERVER_READ_SIZE 65536           // Initial size of a connection's receive buffer (grown for longer request lines)
+
+// Benchmark parameters
+#define BENCH_NUM_CLIENTS 4              // Number of concurrent client connections
+#define BENCH_DURATION 2.0               // Duration of the measurement at each request rate (seconds)
+#define BENCH_NUM_TASKSETS 1000          // Number of distinct tasksets sent by the clients (round robin)
+#define BENCH_UTILIZATION 0.50           // Utilization of the generated tasksets
+#define BENCH_CRITICALITY_PROPORTION 0.50    // Criticality proportion of the generated tasksets
+#define BENCH_NUM_RATES 6                // Number of request rates measured
+#define BENCH_RATES {1000.0, 2000.0, 5000.0, 10000.0, 20000.0, 50000.0}   // Request rates (requests per second, over all clients)
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Group of requests received together on a connection, completed as a whole before the responses are written
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t done;                 // Signalled when the last request of the group is completed
+    int remaining;                       // Number of requests of the group not yet analysed
+} RequestGroup;
+
+// Single analysis request
+typedef struct {
+    McqpaTaskset *taskset;               // Taskset to be analysed (NULL if the request line is invalid)
+    McqpaResult result;                  // Analysis result
+    int status;                          // MCQPA_OK, or an MCQPA_E* error code
+    RequestGroup *group;                 // Group the request belongs to
+} Request;
+
+// Bounded queue of pending requests (shared by all connections and workers)
+typedef struct {
+    Request **requests;                  // Circular buffer of pending requests
+    int capacity;                        // Buffer capacity
+    int head;                            // Index of the oldest pending request
+    int count;                           // Number of pending requests
+    int shutdown;                        // Set to 1 to stop the workers once the queue is drained
+    long long int num_requests;          // Total number of requests dequeued by the workers
+    long long int num_batches;           // Total number of batches dequeued by the workers
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} RequestQueue;
+
+// Analysis server
+typedef struct {
+    RequestQueue queue;                  // Pending requests
+    pthread_t *workers;                  // Worker threads, each one keeping a warm analysis context
+    int num_workers;                     // Number of worker threads
+    int listen_fd;                       // Listening Unix domain socket (-1 if the server is not listening)
+    pthread_t acceptor;                  // Thread accepting the client connections
+    int *connection_fds;                 // Sockets of the live client connections
+    int num_connections;                 // Number of live connection threads
+    int connections_capacity;            // Capacity of connection_fds
+    pthread_mutex_t connections_mutex;
+    pthread_cond_t connections_done;     // Signalled when the last connection thread exits
+    char socket_path[108];               // Path of the Unix domain socket
+} Server;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Start the worker pool, and accept connections on the Unix domain socket socket_path (unless NULL). Return the server
+Server* start_server (const char *socket_path, int num_workers);
+
+// Serve the requests read from in_fd, writing the responses to out_fd, until end of file
+void serve_connection (Server *server, int in_fd, int out_fd);
+
+// Stop accepting connections, wait for the live connections, drain the queue and stop the workers
+void stop_server (Server *server);
+
+// Run the server on the Unix domain socket socket_path (forever), or on stdin/stdout if socket_path is NULL (until end of file)
+void run_server (const char *socket_path);
+
+// Measure the server latency percentiles and throughput at different request rates, print the results to the terminal and the output file
+void run_server_benchmark (FILE *output_file);
+
+#endif
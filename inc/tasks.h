@@ -25,7 +25,6 @@ typedef struct {
     int deadline;                        // Relative deadline 
     double wcet[2];                      // Worst-case execution times of the task at each criticality level [dual-criticality system]
     double utilization[2];               // Task utilizations at each criticality level [dual-criticality system]
-    int num_jobs;                        // Number of jobs in floor_upper_bound_t interval
 } Tasks;
 
 #endif
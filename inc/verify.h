@@ -0,0 +1,70 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdio.h>
+#include "tasks.h"
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Verification policies: which MC-QPA verdicts are cross-checked against the Iterative test
+#define VERIFY_ALL 0                     // Cross-check every taskset (slowest, original behaviour)
+#define VERIFY_NONE 1                    // Run MC-QPA only
+#define VERIFY_SAMPLED 2                 // Cross-check a random fraction of the tasksets
+#define VERIFY_STRATIFIED 3              // Cross-check a fixed fraction of the tasksets within each MC-QPA verdict
+#define VERIFY_BELOW_B 4                 // Cross-check only the tasksets whose floor(B) does not exceed a given limit
+
+// Selected verification policy and its parameters (may be overridden at compile time, e.g. -DVERIFICATION_POLICY=VERIFY_NONE)
+#ifndef VERIFICATION_POLICY
+#define VERIFICATION_POLICY VERIFY_ALL
+#endif
+
+#ifndef VERIFICATION_FRACTION
+#define VERIFICATION_FRACTION 0.10       // Fraction of tasksets cross-checked by the VERIFY_SAMPLED and VERIFY_STRATIFIED policies
+#endif
+
+#ifndef VERIFICATION_B_LIMIT
+#define VERIFICATION_B_LIMIT 1000000.0   // Largest floor(B) cross-checked by the VERIFY_BELOW_B policy
+#endif
+
+// Reproducer file for tasksets on which both tests disagree (same format as "input.txt")
+#define MISMATCH_FILE "mismatch.txt"
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Verification state structure
+typedef struct {
+    int policy;                          // One of the VERIFY_* policies
+    double fraction;                     // Fraction of tasksets to be cross-checked (VERIFY_SAMPLED, VERIFY_STRATIFIED)
+    double b_limit;                      // Largest floor(B) to be cross-checked (VERIFY_BELOW_B)
+    unsigned int seed;                   // Private random number generator state, keeps the taskset generator sequence untouched
+    int num_seen[2];                     // Number of tasksets seen in the current stratum, indexed by MC-QPA verdict
+    int num_verified[2];                 // Number of tasksets cross-checked in the current stratum, indexed by MC-QPA verdict
+    int num_mismatches;                  // Total number of tasksets on which both tests disagree
+    FILE *mismatch_file;                 // Reproducer file, opened on the first mismatch
+} Verification;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize the verification state with the compile-time selected policy
+void init_verification (Verification *verification, unsigned int seed);
+
+// Reset the per-stratum counters (called at the start of every sweep cell)
+void reset_verification_strata (Verification *verification);
+
+// Decide whether the taskset analysed by MC-QPA must also be cross-checked by the Iterative test
+int verification_required (Verification *verification, Schedulability *schedulability_mcqpa);
+
+// Compare the verdict of the named test with the MC-QPA verdict, append a reproducer to MISMATCH_FILE if they differ. Return 1 on mismatch, else 0
+int check_verdicts (Verification *verification, const char *test_name, const Tasks *tasks, int num_tasks, Schedulability *schedulability, Schedulability *schedulability_mcqpa);
+
+// Finalize the reproducer file (if any) and release the verification state
+void close_verification (Verification *verification);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef WITNESS_H
+#define WITNESS_H
+
+#include "schedtest.h"
+
+// =================
+// MACRO DEFINITIONS
+// =================
+
+// Number of violation witnesses kept for witness-first re-testing of similar tasksets (0 --> plain MC-QPA)
+#ifndef WITNESS_POOL_SIZE
+#define WITNESS_POOL_SIZE 16
+#endif
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Pool of the most recent distinct violation witnesses (ring buffer)
+typedef struct {
+    Witness witnesses[WITNESS_POOL_SIZE + 1];    // Witnesses (one spare entry, so that the array is never empty)
+    int num_witnesses;                           // Number of valid witnesses
+    int next;                                    // Index overwritten by the next witness once the pool is full
+} WitnessPool;
+
+// =====================
+// FUNCTION DECLARATIONS
+// =====================
+
+// Initialize an empty witness pool
+void init_witness_pool (WitnessPool *witness_pool);
+
+// Add the violation witness of a NOT_SCHEDULABLE test result to the pool (results without a witness and known witnesses are ignored)
+void add_witness (WitnessPool *witness_pool, const Schedulability *schedulability);
+
+#endif
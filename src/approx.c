@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../inc/auxiliary.h"
+#include "../inc/schedtest.h"
+
+// Approximate test (in the style of the approximate demand bound function tests [5]) with exact fallback on MC-QPA
+//
+// DBFi(t, s) only depends on t, s and u = t - s through the job counts psi_i(t), psi_i(u) (HI criticality tasks) and floor(s / Ti) + 1
+// (LO criticality tasks). Each job count is kept exact for the first k = ceil(1 / APPROX_EPSILON) jobs and replaced by its linear upper
+// envelope (x - Di) / Ti + 1 beyond, which overestimates it by a factor of at most 1 + 1 / k <= 1 + APPROX_EPSILON. The approximate demand
+// A(t, s) thus bounds the sum of DBFi(t, s) from above and exceeds it by at most that factor, and only steps on the lines t = d, u = h and
+// s = m (d, h: first k deadlines of all / HI criticality tasks, m: first k releases of the LO criticality tasks with Ci(LO) != Ci(HI)).
+// In between, A(t, s) - t decreases with t for a fixed u (slope U_LO - 1 < 0), for s = 0 (slope U_HI - 1 < 0) and, if the sum of Ui of all tasks
+// at their own criticality level is at most 1, for a fixed s. For a fixed t it is piecewise linear, and the envelopes of a LO criticality task
+// cross at s = t - Di. Its maximum over 0 <= s <= t <= B is therefore reached at:
+//  - t = d and s in {0} U {d - h} U {m} U {d - Di}, i.e. S(t) restricted to the first k jobs of each HI criticality task (h = 0 included),
+//    plus the LO release points and envelope crossings, and
+//  - s = m and t = m + h
+// so A(t, s) <= t at these points (up to floor(B)) proves schedulability. The exact demand at the same points proves unschedulability when it
+// exceeds t. Otherwise the approximation is inconclusive and MC-QPA decides.
+
+// Get the number of jobs of the given interval, exact for the first num_exact_jobs jobs and bounded by its linear envelope beyond
+
+static double get_approx_num_jobs (long long int interval, int deadline, int period, int num_exact_jobs) {
+
+    // Exact job count up to the num_exact_jobs-th deadline (excluded)
+    if (interval < deadline + (long long int)(num_exact_jobs - 1) * period)
+        return get_num_jobs(interval, deadline, period);
+
+    // Linear upper envelope beyond (equal to the exact job count at the num_exact_jobs-th deadline)
+    return (interval - deadline) / (1.0 * period) + 1.0;
+}
+
+// Get the approximate processor demand A(t, s): sum of DBFi(t, s) as per eqn 1 and eqn 2, with approximate job counts
+
+static double get_approx_processor_demand (const Tasks *tasks, int num_tasks, long long int t, long long int s, int num_exact_jobs) {
+
+    double processor_demand = 0.0;    // Approximate sum of DBFi(t, s) over all tasks
+    double num_jobs = 0.0;            // Approximate psi_i(t)
+
+    for (int i = 0; i < num_tasks; i++) {
+
+        num_jobs = get_approx_num_jobs(t, tasks[i].deadline, tasks[i].period, num_exact_jobs);
+
+        if (tasks[i].criticality == LO)
+            processor_demand += num_jobs * tasks[i].wcet[HI] + fmin(get_approx_num_jobs(s, 0, tasks[i].period, num_exact_jobs), num_jobs) * (tasks[i].wcet[LO] - tasks[i].wcet[HI]);
+        else
+            processor_demand += num_jobs * tasks[i].wcet[LO] + get_approx_num_jobs(t - s, tasks[i].deadline, tasks[i].period, num_exact_jobs) * (tasks[i].wcet[HI] - tasks[i].wcet[LO]);
+    }
+
+    return processor_demand;
+}
+
+// Sort the given points and remove the duplicates. Return the number of distinct points
+
+static int sort_points (long long int *points, int num_points) {
+
+    int num_distinct = 0;             // Number of distinct points
+
+    qsort(points, num_points, sizeof(long long int), sort_comparator);
+    for (int idx = 0; idx < num_points; idx++)
+        if (num_distinct == 0 || points[idx] != points[num_distinct - 1])
+            points[num_distinct++] = points[idx];
+
+    return num_distinct;
+}
+
+Schedulability* schedulability_test_approx (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace) {
+
+    double lo_util_sum = 0.0;                    // Sum of LO criticality utilizations of all tasks U_LO
+    double hi_util_sum = 0.0;                    // Sum of HI criticality utilizations of all tasks U_HI
+    double max_util_sum = 0.0;                   // Max {U_HI, U_LO}
+    double own_util_sum = 0.0;                   // Sum of utilizations of all tasks at their own criticality level, the largest slope of A(t, s) for a fixed s
+    double wcet_sum = 0.0;                       // Sum of wcets of all tasks at their own criticality level
+    double t_upper_bound = 0.0;                  // [a.k.a. B] Upper bound for t that we need to consider when using DBFi(t, s) for a schedulability test
+    long long int floor_t_upper_bound = 0;       // Floor of t upper bound
+    int num_exact_jobs = 0;                      // [a.k.a. k] Number of jobs of each task for which the job counts are exact
+    long long int *points;                       // Memory block of the deadline, HI deadline, LO release and LO deadline points below
+    long long int *deadlines;                    // [a.k.a. d] First k deadlines of all tasks, up to floor(B)
+    long long int *hi_deadlines;                 // [a.k.a. h] 0 and the first k deadlines of the HI criticality tasks, up to floor(B)
+    long long int *lo_releases;                  // [a.k.a. m] First k releases (> 0) of the LO criticality tasks with Ci(LO) != Ci(HI), up to floor(B)
+    long long int *lo_deadlines;                 // Deadlines Di of the LO criticality tasks with Ci(LO) != Ci(HI) (envelope crossings at s = t - Di)
+    int num_deadlines = 0;                       // Number of distinct deadline points
+    int num_hi_deadlines = 0;                    // Number of distinct HI deadline points
+    int num_lo_releases = 0;                     // Number of distinct LO release points
+    int num_lo_deadlines = 0;                    // Number of distinct LO deadlines
+    long long int point = 0;                     // Deadline or release point being collected
+    int monotone = 1;                            // Set to 0 if some task has decreasing wcets across the criticality levels (the envelope argument does not apply)
+    int upper_bound_holds = 0;                   // Set to 1 while the approximate demand proves schedulability at all candidate (t, s) points
+    long long int t = 0;                         // t point at which the demand is calculated
+    long long int s = 0;                         // s point at which the demand is calculated
+    int s_idx = 0;                               // Index over the s points of the current t point
+    int num_s_points = 0;                        // Number of s points of the current t point
+    double approx_demand = 0.0;                  // Approximate processor demand A(t, s), an upper bound of the exact demand
+    double exact_demand = 0.0;                   // Exact sum of DBFi(t, s), only calculated when the approximate demand exceeds t
+    long long int approx_t_points = 0;           // Number of t points checked by the approximation
+    long long int approx_t_s_points = 0;         // Number of (t, s) points checked by the approximation
+    long long int approx_memory = 0;             // Memory (in bytes) allocated by the approximation
+
+    // Initializing schedulability struct variables
+    schedulability->taskset_schedulability = DEFAULT;
+    schedulability->t_s_points = 0;
+    schedulability->t_points = 0;
+    schedulability->peak_memory = 0;
+    schedulability->approx_fallback = 0;
+    schedulability->witness.t = 0;
+    schedulability->witness.s = 0;
+    schedulability->witness.demand = 0.0;
+    schedulability->kernel = KERNEL_GENERIC;
+    schedulability->cached_t_points = 0;
+
+    // Check the first EDF schedulability condition: Max{U_HI, U_LO} < 1.0 for the given taskset
+
+    // Calculate U_LO, U_HI and the largest slope of A(t, s) for a fixed s
+    for (int i = 0; i < num_tasks; i++) {
+        lo_util_sum += tasks[i].utilization[LO];
+        hi_util_sum += tasks[i].utilization[HI];
+        own_util_sum += tasks[i].utilization[(tasks[i].criticality)];
+    }
+
+    // Get max{U_LO, U_HI}
+    max_util_sum = max(lo_util_sum, hi_util_sum);
+
+    // If the first EDF schedulability condition is NOT satisfied
+    if (max_util_sum >= 1.0) {
+        schedulability->interval_length = 0.0;
+        schedulability->failed_case1 = 1;
+        schedulability->failed_case2 = 1;
+        schedulability->taskset_schedulability = NOT_SCHEDULABLE;
+        return schedulability;
+    }
+
+    // Calculate wcet sum of all tasks at their own criticality levels
+    for (int i = 0; i < num_tasks; i++)
+        wcet_sum += tasks[i].wcet[(tasks[i].criticality)];
+
+    // Calculate floor B (DBF analysis is performed at integer points)
+    t_upper_bound = wcet_sum / (1.0 - max_util_sum);
+    floor_t_upper_bound = (long long int)(floor(t_upper_bound));
+    schedulability->interval_length = floor_t_upper_bound;
+
+    // Determine k for the requested accuracy (1 + 1 / k <= 1 + APPROX_EPSILON)
+    num_exact_jobs = (int)(ceil(1.0 / APPROX_EPSILON));
+    if (num_exact_jobs < 1)
+        num_exact_jobs = 1;
+
+    // Reserve memory for the deadline, HI deadline and LO release points, and the LO deadlines
+    approx_memory = (3LL * num_tasks * num_exact_jobs + num_tasks + 1) * (long long int)sizeof(long long int);
+    points = malloc((size_t)approx_memory);
+    schedulability->peak_memory = approx_memory;
+    if (points == NULL) {
+        schedulability->taskset_schedulability = OUT_OF_MEMORY;
+        return schedulability;
+    }
+    deadlines = points;
+    hi_deadlines = deadlines + (long long int)num_tasks * num_exact_jobs;
+    lo_releases = hi_deadlines + (long long int)num_tasks * num_exact_jobs + 1;
+    lo_deadlines = lo_releases + (long long int)num_tasks * num_exact_jobs;
+
+    // Collect the first k deadlines of all tasks, and the first k releases of the LO criticality tasks, up to floor(B)
+    hi_deadlines[num_hi_deadlines++] = 0;
+    for (int i = 0; i < num_tasks; i++) {
+
+        // The job counts of DBFi(t, s) have non-negative coefficients only if the wcets do not decrease towards the task's criticality level
+        if (tasks[i].wcet[LO] < 0.0 || tasks[i].wcet[HI] < 0.0 || tasks[i].wcet[(tasks[i].criticality)] < tasks[i].wcet[!(tasks[i].criticality)])
+            monotone = 0;
+
+        for (int j = 0; j < num_exact_jobs; j++) {
+            point = tasks[i].deadline + (long long int)j * tasks[i].period;
+            if (point > floor_t_upper_bound)
+                break;
+            deadlines[num_deadlines++] = point;
+            if (tasks[i].criticality == HI)
+                hi_deadlines[num_hi_deadlines++] = point;
+        }
+
+        if (tasks[i].criticality == LO && tasks[i].wcet[LO] != tasks[i].wcet[HI]) {
+            lo_deadlines[num_lo_deadlines++] = tasks[i].deadline;
+            for (int j = 1; j < num_exact_jobs; j++) {
+                point = (long long int)j * tasks[i].period;
+                if (point > floor_t_upper_bound)
+                    break;
+                lo_releases[num_lo_releases++] = point;
+            }
+        }
+    }
+    num_deadlines = sort_points(deadlines, num_deadlines);
+    num_hi_deadlines = sort_points(hi_deadlines, num_hi_deadlines);
+    num_lo_releases = sort_points(lo_releases, num_lo_releases);
+    num_lo_deadlines = sort_points(lo_deadlines, num_lo_deadlines);
+
+    // The envelope argument requires non-negative job count coefficients, and a slope of at most 1 for a fixed s on the LO release lines
+    upper_bound_holds = monotone && (num_lo_releases == 0 || own_util_sum <= 1.0);
+
+    // For all candidate (t, s) points: t = d with its s points (first pass), then s = m with t = m + h (second pass)
+    for (int pass = 0; pass < 2 && schedulability->taskset_schedulability == DEFAULT; pass++) {
+        for (int idx = 0; idx < (pass == 0 ? num_deadlines : num_lo_releases); idx++) {
+
+            // s points of t = d: {0} U {d - h} U {m} U {d - Di} within [0, d]. Pairs of s = m: {m + h <= floor(B)}
+            num_s_points = (pass == 0) ? (1 + num_hi_deadlines + num_lo_releases + num_lo_deadlines) : num_hi_deadlines;
+            if (pass == 0)
+                approx_t_points++;
+
+            for (s_idx = 0; s_idx < num_s_points; s_idx++) {
+
+                // Get the next (t, s) point
+                if (pass == 0) {
+                    t = deadlines[idx];
+                    if (s_idx == 0)
+                        s = 0;
+                    else if (s_idx < 1 + num_hi_deadlines)
+                        s = t - hi_deadlines[s_idx - 1];
+                    else if (s_idx < 1 + num_hi_deadlines + num_lo_releases)
+                        s = lo_releases[s_idx - 1 - num_hi_deadlines];
+                    else
+                        s = t - lo_deadlines[s_idx - 1 - num_hi_deadlines - num_lo_releases];
+                    if (s < 0 || s > t)
+                        continue;
+                }
+                else {
+                    s = lo_releases[idx];
+                    t = s + hi_deadlines[s_idx];
+                    if (t > floor_t_upper_bound)
+                        break;
+                    approx_t_points++;
+                }
+
+                approx_t_s_points++;
+
+                // The approximate demand bounds the exact demand from above, so the exact demand can only exceed t where the approximate one does
+                approx_demand = get_approx_processor_demand(tasks, num_tasks, t, s, num_exact_jobs);
+                if (approx_demand <= t)
+                    continue;
+                upper_bound_holds = 0;
+
+                // The exact processor demand at (t, s) exceeds t --> Taskset is NOT_SCHEDULABLE
+                exact_demand = get_processor_demand(tasks, num_tasks, t, s);
+                if (exact_demand > t) {
+                    schedulability->failed_case1 = (t <= (0.5 * floor_t_upper_bound));
+                    schedulability->failed_case2 = (t <= (0.25 * floor_t_upper_bound));
+                    schedulability->witness.t = t;
+                    schedulability->witness.s = s;
+                    schedulability->witness.demand = exact_demand;
+                    schedulability->taskset_schedulability = NOT_SCHEDULABLE;
+                    break;
+                }
+            }
+
+            if (schedulability->taskset_schedulability != DEFAULT)
+                break;
+        }
+    }
+
+    free(points);
+
+    schedulability->t_points = approx_t_points;
+    schedulability->t_s_points = approx_t_s_points;
+
+    // The approximate demand stays below t at all candidate points --> Taskset is SCHEDULABLE
+    if (schedulability->taskset_schedulability == DEFAULT && upper_bound_holds)
+        schedulability->taskset_schedulability = SCHEDULABLE;
+
+    // Inconclusive approximation --> exact fallback on MC-QPA, reporting the points checked by both
+    else if (schedulability->taskset_schedulability == DEFAULT) {
+        schedulability_test_mcqpa(tasks, num_tasks, schedulability, workspace);
+        schedulability->approx_fallback = 1;
+        schedulability->t_points += approx_t_points;
+        schedulability->t_s_points += approx_t_s_points;
+        if (schedulability->peak_memory < approx_memory)
+            schedulability->peak_memory = approx_memory;
+    }
+
+    return schedulability;
+}
@@ -1,127 +1,364 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include "../inc/tasks.h"
+#include <limits.h>
+#include "../inc/auxiliary.h"
 
-// Get the number of jobs arriving and having deadlines within the given interval
+// Get the processor demand sum of DBFi(t, s) over all tasks for the given (t, s) values (0 <= s <= t)
 
-int get_num_jobs (long long int interval, int deadline, int period) {
+double get_processor_demand (const Tasks *tasks, int num_tasks, long long int t, long long int s) {
 
-    int num_jobs = 0;    // psi_i(t) [3]: number of jobs arriving and having deadlines within the given interval
+    double processor_demand = 0.0;    // Sum of DBFi(t, s) over all tasks
+    long long int num_jobs = 0;       // psi_i(t)
 
-    // Calculate the number of jobs arriving and having deadlines within the given interval
-    num_jobs = (int)(floor((interval - deadline) / (1.0 * period))) + 1;
+    for (int i = 0; i < num_tasks; i++) {
 
-    // If number of jobs < 0, set number of jobs equal to 0
-    if (num_jobs < 0)
-        num_jobs = 0;
+        num_jobs = get_num_jobs(t, tasks[i].deadline, tasks[i].period);
 
-    return num_jobs;
+        // DBFi as per eqn 1 (LO criticality task) or eqn 2 (HI criticality task)
+        if (tasks[i].criticality == LO)
+            processor_demand += num_jobs * tasks[i].wcet[HI] + min(s / tasks[i].period + 1, num_jobs) * (tasks[i].wcet[LO] - tasks[i].wcet[HI]);
+        else
+            processor_demand += num_jobs * tasks[i].wcet[LO] + get_num_jobs(t - s, tasks[i].deadline, tasks[i].period) * (tasks[i].wcet[HI] - tasks[i].wcet[LO]);
+    }
+
+    return processor_demand;
 }
 
-// Quick sort comparator
+// Restore the min-heap property of the S(t) progressions heap, starting from the given index
+
+static void sift_down_s_points_heap (SPointsCursor *heap, int heap_size, int idx) {
+
+    SPointsCursor cursor = heap[idx];    // Progression being moved down the heap
+    int child = 0;                       // Index of the smaller child
+
+    while ((child = 2 * idx + 1) < heap_size) {
+
+        // Pick the child with the smaller next s point
+        if (child + 1 < heap_size && heap[child + 1].next < heap[child].next)
+            child++;
+
+        if (cursor.next <= heap[child].next)
+            break;
+
+        heap[idx] = heap[child];
+        idx = child;
+    }
+
+    heap[idx] = cursor;
+}
+
+// Initialize a sorted S(t) generator for the given t, where S(t) = Arrival times of all hi-criticality jobs U {t}
+// Each HI criticality task contributes the already sorted progression (t - Di) mod Ti, ..., t - Ti - Di, t - Di,
+// so S(t) is obtained by a k-way merge of these progressions instead of a comparison sort of all the s points
+
+void init_s_points_iterator (SPointsIterator *iterator, SPointsCursor *heap, const Tasks *tasks, int num_tasks, long long int t) {
+
+    iterator->heap = heap;
+    iterator->heap_size = 0;
+    iterator->t = t;
+    iterator->last_s_point = 0;
+    iterator->num_returned = 0;
+    iterator->t_returned = 0;
+    iterator->offsets = NULL;
+    iterator->num_offsets = 0;
+
+    // For all HI criticality tasks having at least one job with arrival time >= 0 [reqd for t < deadline]
+    for (int i = 0; i < num_tasks; i++) {
+        if (tasks[i].criticality == HI && t >= tasks[i].deadline) {
+            heap[iterator->heap_size].next = (t - tasks[i].deadline) % tasks[i].period;
+            heap[iterator->heap_size].last = t - tasks[i].deadline;
+            heap[iterator->heap_size].period = tasks[i].period;
+            iterator->heap_size++;
+        }
+    }
 
-int sort_comparator (const void * a, const void * b) {
-   return ( *(long long int *)a - *(long long int *)b );
+    // Build the min-heap bottom-up
+    for (int idx = iterator->heap_size / 2 - 1; idx >= 0; idx--)
+        sift_down_s_points_heap(heap, iterator->heap_size, idx);
 }
 
-// Sorting and deduplicating the s points array
+// Initialize a sorted S(t) generator for the given t from a job lattice: the offsets <= t, scanned backwards, give S(t) \ {t} in increasing
+// order without duplicates. Return 1 on success, 0 if t exceeds the lattice bound (S(t) must then be merged)
 
-int sort_deduplicate_s_points (long long int *s_points, int num_s_points) {
+int init_s_points_iterator_cached (SPointsIterator *iterator, const JobLattice *lattice, long long int t) {
 
-    int j = 0;    // To store index of next unique element
+    int low = 0;                         // Index of the first offset known to be > t, searched by bisection
+    int high = 0;
+    int mid = 0;
 
-    // Quick sort s points in increasing order
-    qsort(s_points, num_s_points, sizeof(long long int), sort_comparator);
+    if (t > lattice->bound)
+        return 0;
 
-    // If array is empty/ contains only 1 element
-    if (num_s_points == 0 || num_s_points == 1)
-        return num_s_points;
+    // Number of offsets <= t
+    high = lattice->num_offsets;
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (lattice->offsets[mid] <= t)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    iterator->heap = NULL;
+    iterator->heap_size = 0;
+    iterator->t = t;
+    iterator->last_s_point = 0;
+    iterator->num_returned = 0;
+    iterator->t_returned = 0;
+    iterator->offsets = lattice->offsets;
+    iterator->num_offsets = low;
+
+    return 1;
+}
+
+// Store the next s point of S(t) (increasing order, without duplicates) in s_point. Return 1 on success, 0 once S(t) is exhausted
+
+int next_s_point (SPointsIterator *iterator, long long int *s_point) {
 
-    // For all array elements
-    for (int i = 0; i < num_s_points - 1; i++) {
+    SPointsCursor *heap = iterator->heap;
+    long long int s = 0;
+
+    // Job lattice: the largest offset not returned yet gives the next s point (the offsets are distinct)
+    if (iterator->num_offsets > 0) {
+        iterator->num_offsets--;
+        s = iterator->t - iterator->offsets[iterator->num_offsets];
+        iterator->last_s_point = s;
+        iterator->num_returned++;
+        *s_point = s;
+        return 1;
+    }
+
+    // While some HI criticality task progression is not exhausted
+    while (iterator->heap_size > 0) {
+
+        // Pop the smallest pending s point
+        s = heap[0].next;
+
+        // Advance the progression it belongs to, or drop the progression if it is exhausted
+        if (heap[0].next <= heap[0].last - heap[0].period)
+            heap[0].next += heap[0].period;
+        else
+            heap[0] = heap[--iterator->heap_size];
+        sift_down_s_points_heap(heap, iterator->heap_size, 0);
+
+        // Skip duplicates (jobs of different tasks arriving at the same time)
+        if (iterator->num_returned == 0 || s != iterator->last_s_point) {
+            iterator->last_s_point = s;
+            iterator->num_returned++;
+            *s_point = s;
+            return 1;
+        }
+    }
 
-        // If current element is not equal to the next element
-        // Store next element
-        if (s_points[i] != s_points[i + 1]) {
-            s_points[j] = s_points[i];
-            j++;
+    // Finally, t is also included in S(t)
+    if (!iterator->t_returned) {
+        iterator->t_returned = 1;
+        if (iterator->num_returned == 0 || iterator->t != iterator->last_s_point) {
+            iterator->last_s_point = iterator->t;
+            iterator->num_returned++;
+            *s_point = iterator->t;
+            return 1;
         }
     }
-    s_points[j] = s_points[num_s_points - 1];
-    j++;
 
-    return j;
+    return 0;
 }
 
-// Determine S(t) for t = floor(B), where S(t) = Arrival times of all hi-criticality jobs U {t} 
-// Store all the s points in s_points array; return array size
+// Determine the next chunk of S(t), where S(t) = Arrival times of all hi-criticality jobs U {t}
+// Store at most max_s_points s points in the s_points chunk, in increasing order without duplicates; return the chunk size
 
-int get_s_points (Tasks *tasks, int num_tasks, long long int *s_points, long long int t) {
+int get_s_points (SPointsIterator *iterator, long long int *s_points, int max_s_points) {
 
-    int s_idx = 0;           // Index used to traverse through the s_points array
-    int num_s_points = 0;    // s points array size
-    int num_jobs = 0;
-    
-    // For all tasks
-    for (int i = 0; i < num_tasks; i++) {
+    int num_s_points = 0;    // s points chunk size
 
-        num_jobs = get_num_jobs(t, tasks[i].deadline, tasks[i].period);
+    // Merge the HI criticality job arrival times in increasing order until the chunk is full or S(t) is exhausted
+    while (num_s_points < max_s_points && next_s_point(iterator, &s_points[num_s_points]))
+        num_s_points++;
+
+    // Return the s_points chunk size
+    return num_s_points;
+}
 
-        // If the given task is HI criticality
-        if (tasks[i].criticality == HI) {
+// Get the largest step point <= t of the maximum processor demand over S(t), i.e. the largest t' <= t such that the demand is constant on [t', t]
+// (0 if t is below all deadlines). The heap array must hold at least num_tasks cursors
+//
+// For s = t - o, where o = Dj + kTj is an offset of a HI criticality task (s in S(t) \ {t}), the processor demand only changes with t at
+//  - the deadlines Di + kTi of all tasks (psi_i(t) steps up), and
+//  - the points o + mTi of the LO criticality tasks with Ci(LO) != Ci(HI) (floor(s / Ti) steps up), once o <= t (s enters S(t))
+// while for s = t it only changes at the deadlines. The largest point o + mTi <= t is t - (s mod Ti), so the step point is found by a single pass over S(t)
 
-            // For all jobs
-            for (int k = 0; k < num_jobs; k++) {
+long long int get_step_point (const Tasks *tasks, int num_tasks, SPointsCursor *heap, long long int t) {
 
-                // Find arrival times for all HI-criticality jobs for the worst-case scenario
-                s_points[s_idx] = t - ((long long int)k * (long long int)tasks[i].period) - tasks[i].deadline;
+    long long int step_point = 0;        // Largest step point <= t found so far
+    long long int candidate = 0;         // Largest step point <= t of a single progression
+    SPointsIterator s_points_iterator;   // Sorted S(t) generator
+    long long int s = 0;                 // s point of S(t)
+    int has_lo_steps = 0;                // Set to 1 if some LO criticality task contributes step points of its own
 
-                // If arrival time value < 0, break out of the loop [reqd for t < deadline]
-                if (s_points[s_idx] < 0) {
-                    break;
-                }
+    // Largest deadline <= t of each task
+    for (int i = 0; i < num_tasks; i++) {
+        if (t >= tasks[i].deadline) {
+            candidate = t - (t - tasks[i].deadline) % tasks[i].period;
+            if (step_point < candidate)
+                step_point = candidate;
+        }
+        if (tasks[i].criticality == LO && tasks[i].wcet[LO] != tasks[i].wcet[HI])
+            has_lo_steps = 1;
+    }
 
-                s_idx++;
+    if (step_point == t || !has_lo_steps)
+        return step_point;
+
+    // Largest point o + mTi <= t of each LO criticality task, for all offsets o = t - s
+    init_s_points_iterator(&s_points_iterator, heap, tasks, num_tasks, t);
+    while (next_s_point(&s_points_iterator, &s) && s < t) {
+        for (int i = 0; i < num_tasks; i++) {
+            if (tasks[i].criticality == LO && tasks[i].wcet[LO] != tasks[i].wcet[HI]) {
+                candidate = t - s % tasks[i].period;
+                if (step_point < candidate)
+                    step_point = candidate;
             }
         }
+        if (step_point == t)
+            break;
     }
 
-    // Finally, floor(B) is also included in S(t)
-    s_points[s_idx] = t;
+    return step_point;
+}
 
-    // The s-points array is now sorted in increasing order and deduplicated
-    num_s_points = sort_deduplicate_s_points (s_points, s_idx + 1);
+// Initialize an empty job lattice
 
-    // Return the s_points array size
-    return num_s_points;
+void init_job_lattice (JobLattice *lattice) {
+
+    lattice->offsets = NULL;
+    lattice->num_offsets = 0;
+    lattice->bound = 0;
 }
 
-// Utility function to calculate total taskset utilization
+// Build the job lattice of the HI criticality tasks of a taskset, covering the largest bound with at most max_offsets job deadlines
 
-double get_taskset_utilization (Tasks *tasks, int num_tasks) {
-    double taskset_utilization = 0.0;
+void build_job_lattice (JobLattice *lattice, const Tasks *tasks, int num_tasks, int max_offsets) {
 
+    long long int low = 0;               // Largest bound known to hold at most max_offsets job deadlines
+    long long int high = LLONG_MAX;      // Smallest bound known to hold more than max_offsets job deadlines
+    long long int mid = 0;               // Bisection point
+    long long int num_jobs = 0;          // Number of HI criticality job deadlines <= bound (duplicates included)
+    int num_offsets = 0;                 // Number of distinct offsets
+
+    free_job_lattice(lattice);
+
+    // A single HI criticality task already has max_offsets + 1 job deadlines <= Di + max_offsets * Ti
     for (int i = 0; i < num_tasks; i++)
-        taskset_utilization += tasks[i].utilization[(tasks[i].criticality)];
+        if (tasks[i].criticality == HI && high > tasks[i].deadline + (long long int)max_offsets * tasks[i].period)
+            high = tasks[i].deadline + (long long int)max_offsets * tasks[i].period;
 
-    return taskset_utilization;
+    // Without HI criticality tasks, S(t) = {t} for any t
+    if (high == LLONG_MAX) {
+        lattice->bound = LLONG_MAX;
+        return;
+    }
+
+    // Bisect for the largest bound with at most max_offsets job deadlines
+    while (high - low > 1) {
+        mid = low + (high - low) / 2;
+        num_jobs = 0;
+        for (int i = 0; i < num_tasks; i++)
+            if (tasks[i].criticality == HI)
+                num_jobs += get_num_jobs(mid, tasks[i].deadline, tasks[i].period);
+        if (num_jobs <= max_offsets)
+            low = mid;
+        else
+            high = mid;
+    }
+    lattice->bound = low;
+
+    // Collect the job deadlines <= bound of all HI criticality tasks
+    lattice->offsets = malloc((max_offsets > 0 ? max_offsets : 1) * sizeof(long long int));
+    for (int i = 0; i < num_tasks; i++)
+        if (tasks[i].criticality == HI)
+            for (long long int offset = tasks[i].deadline; offset <= low; offset += tasks[i].period)
+                lattice->offsets[num_offsets++] = offset;
+
+    // Sort them and drop the duplicates (jobs of different tasks with the same deadline)
+    qsort(lattice->offsets, num_offsets, sizeof(long long int), sort_comparator);
+    lattice->num_offsets = 0;
+    for (int idx = 0; idx < num_offsets; idx++)
+        if (lattice->num_offsets == 0 || lattice->offsets[idx] != lattice->offsets[lattice->num_offsets - 1])
+            lattice->offsets[lattice->num_offsets++] = lattice->offsets[idx];
+}
+
+// Release the memory held by the job lattice
+
+void free_job_lattice (JobLattice *lattice) {
+
+    free(lattice->offsets);
+    init_job_lattice(lattice);
 }
 
-// Utility function to find the minimum of 2 numbers
+// Initialize an empty workspace
+
+void init_workspace (Workspace *workspace) {
 
-int min (int a, int b) {
-    if (a <= b)
-        return a;
-    else
-        return b;
+    workspace->s_points = NULL;
+    workspace->s_points_capacity = 0;
+    workspace->s_points_heap = NULL;
+    workspace->heap_capacity = 0;
+    workspace->cancel = NULL;
+    workspace->lattice = NULL;
+    init_demand_kernel(&workspace->kernel);
 }
 
-// Utility function to find the maximum of 2 numbers
+// Grow the workspace (if needed) to hold max_s_points s points, the S(t) generator and the demand kernel of num_tasks tasks.
+// Return 1 on success, 0 if out of memory (the workspace stays valid and may be reused or freed)
+
+int reserve_workspace (Workspace *workspace, int max_s_points, int num_tasks) {
+
+    // The memory is only ever grown, a warm workspace performs no allocation
+    if (workspace->s_points_capacity < max_s_points) {
+        free(workspace->s_points);
+        workspace->s_points = malloc(max_s_points * sizeof(long long int));
+        workspace->s_points_capacity = (workspace->s_points != NULL) ? max_s_points : 0;
+        if (workspace->s_points == NULL)
+            return 0;
+    }
 
-double max (double a, double b) {
-    if (a >= b)
-        return a;
-    else
-        return b;
+    if (workspace->heap_capacity < num_tasks) {
+        free(workspace->s_points_heap);
+        workspace->s_points_heap = malloc(num_tasks * sizeof(SPointsCursor));
+        workspace->heap_capacity = (workspace->s_points_heap != NULL) ? num_tasks : 0;
+        if (workspace->s_points_heap == NULL)
+            return 0;
+    }
+
+    return reserve_demand_kernel(&workspace->kernel, num_tasks);
+}
+
+// Return 1 if the test using the workspace has been cancelled by another thread, else 0
+
+int test_cancelled (const Workspace *workspace) {
+
+    // Relaxed load: the flag is polled once per t point, a late observation only delays the cancellation by one t point
+    return workspace->cancel != NULL && atomic_load_explicit(workspace->cancel, memory_order_relaxed);
+}
+
+// Release the memory held by the workspace
+
+void free_workspace (Workspace *workspace) {
+
+    free(workspace->s_points);
+    free(workspace->s_points_heap);
+    free_demand_kernel(&workspace->kernel);
+    init_workspace(workspace);
+}
+
+// Utility function to calculate total taskset utilization
+
+double get_taskset_utilization (const Tasks *tasks, int num_tasks) {
+    double taskset_utilization = 0.0;
+
+    for (int i = 0; i < num_tasks; i++)
+        taskset_utilization += tasks[i].utilization[(tasks[i].criticality)];
+
+    return taskset_utilization;
 }
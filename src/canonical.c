@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../inc/canonical.h"
+
+// Exact task merging
+//
+// DBFi(t, s) is linear in the wcets of task i for a given (period, deadline, criticality):
+//    LO criticality: N(t) * Ci(HI) + min(s / Ti + 1, N(t)) * (Ci(LO) - Ci(HI))
+//    HI criticality: N(t) * Ci(LO) + N(t - s) * (Ci(HI) - Ci(LO))
+// so tasks sharing these three parameters can be replaced by a single task with the summed wcets without changing the processor demand
+// anywhere, nor U_LO, U_HI and B. A task whose wcets are all zero adds no demand and is dropped. Every (t, s) point then costs O(n') with
+// n' <= n the number of canonical tasks.
+
+// Canonical task order: criticality, then period, then deadline (tasks of the same criticality are contiguous, so the criticality
+// branch of the demand loop is predictable, and mergeable tasks are adjacent)
+
+static int compare_tasks (const void *a, const void *b) {
+
+    const Tasks *task_a = a;
+    const Tasks *task_b = b;
+
+    if (task_a->criticality != task_b->criticality)
+        return (task_a->criticality < task_b->criticality) ? -1 : 1;
+    if (task_a->period != task_b->period)
+        return (task_a->period < task_b->period) ? -1 : 1;
+    if (task_a->deadline != task_b->deadline)
+        return (task_a->deadline < task_b->deadline) ? -1 : 1;
+
+    // Keep the input order among mergeable tasks (the first one gives its task number to the merged task)
+    return (task_a->task_no > task_b->task_no) - (task_a->task_no < task_b->task_no);
+}
+
+// Canonicalize a taskset before analysis. Return the number of canonical tasks
+
+int canonicalize_taskset (const Tasks *tasks, int num_tasks, Tasks *canonical_tasks) {
+
+    int num_canonical_tasks = 0;    // Number of canonical tasks
+    Tasks *last = NULL;             // Last canonical task
+
+    // Precondition check
+    assert(tasks != NULL && canonical_tasks != NULL && canonical_tasks != tasks && num_tasks >= 0);
+
+    // Drop the tasks without demand
+    for (int i = 0; i < num_tasks; i++)
+        if (tasks[i].wcet[LO] != 0.0 || tasks[i].wcet[HI] != 0.0)
+            canonical_tasks[num_canonical_tasks++] = tasks[i];
+
+    // Order the tasks (mergeable tasks become adjacent)
+    qsort(canonical_tasks, num_canonical_tasks, sizeof(Tasks), compare_tasks);
+
+    // Merge the runs of tasks with identical (period, deadline, criticality)
+    num_tasks = num_canonical_tasks;
+    num_canonical_tasks = 0;
+    for (int i = 0; i < num_tasks; i++) {
+
+        if (last != NULL && last->criticality == canonical_tasks[i].criticality && last->period == canonical_tasks[i].period && last->deadline == canonical_tasks[i].deadline) {
+            last->wcet[LO] += canonical_tasks[i].wcet[LO];
+            last->wcet[HI] += canonical_tasks[i].wcet[HI];
+            last->utilization[LO] += canonical_tasks[i].utilization[LO];
+            last->utilization[HI] += canonical_tasks[i].utilization[HI];
+        }
+        else {
+            canonical_tasks[num_canonical_tasks] = canonical_tasks[i];
+            last = &canonical_tasks[num_canonical_tasks];
+            num_canonical_tasks++;
+        }
+    }
+
+    return num_canonical_tasks;
+}
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../inc/crn.h"
+#include "../inc/generator.h"
+#include "../inc/canonical.h"
+
+// Common random numbers sweep
+//
+// The utilization levels of a criticality proportion only differ by the total utilization that UUnifast distributes, and the UUnifast
+// utilization vector scales linearly with it. Rescaling the same base tasksets at every level thus draws from the same distribution as
+// fresh tasksets, while the verdicts of neighbouring cells become positively correlated (less variance between cells). Everything that
+// does not depend on the wcets is computed once per base taskset: the canonical form and the job lattice from which MC-QPA reads S(t).
+
+// Initialize an empty pool of base tasksets
+
+void init_base_taskset_pool (BaseTasksetPool *pool, int num_tasks, double criticality_proportion) {
+
+    // Precondition check
+    assert(pool != NULL && num_tasks > 0);
+
+    pool->bases = NULL;
+    pool->num_bases = 0;
+    pool->capacity = 0;
+    pool->num_tasks = num_tasks;
+    pool->criticality_proportion = criticality_proportion;
+    pool->num_offsets = 0;
+}
+
+// Get the k-th base taskset of the pool, generating the missing ones in order
+
+const BaseTaskset* get_base_taskset (BaseTasksetPool *pool, int k) {
+
+    BaseTaskset *base;                   // Base taskset being generated
+
+    // Precondition check
+    assert(pool != NULL && k >= 0);
+
+    while (pool->num_bases <= k) {
+
+        // Double the capacity of the pool when it is full
+        if (pool->num_bases == pool->capacity) {
+            pool->capacity = (pool->capacity > 0) ? 2 * pool->capacity : 64;
+            pool->bases = realloc(pool->bases, pool->capacity * sizeof(BaseTaskset));
+            assert(pool->bases != NULL);
+        }
+
+        // Generate the base taskset, its canonical form and its job lattice
+        base = &pool->bases[pool->num_bases];
+        base->tasks = malloc(pool->num_tasks * sizeof(Tasks));
+        base->canonical_tasks = malloc(pool->num_tasks * sizeof(Tasks));
+        base_taskset_generator(base->tasks, pool->num_tasks, pool->criticality_proportion);
+        base->num_canonical_tasks = canonicalize_taskset(base->tasks, pool->num_tasks, base->canonical_tasks);
+        init_job_lattice(&base->lattice);
+        build_job_lattice(&base->lattice, base->tasks, pool->num_tasks, JOB_LATTICE_MAX_OFFSETS);
+
+        pool->num_offsets += base->lattice.num_offsets;
+        pool->num_bases++;
+    }
+
+    return &pool->bases[k];
+}
+
+// Release the memory held by the pool
+
+void free_base_taskset_pool (BaseTasksetPool *pool) {
+
+    for (int k = 0; k < pool->num_bases; k++) {
+        free(pool->bases[k].tasks);
+        free(pool->bases[k].canonical_tasks);
+        free_job_lattice(&pool->bases[k].lattice);
+    }
+    free(pool->bases);
+    init_base_taskset_pool(pool, pool->num_tasks, pool->criticality_proportion);
+}
@@ -5,30 +5,196 @@
 #include "../inc/generator.h"
 #include "../inc/auxiliary.h"
 #include "../inc/schedtest.h"
+#include "../inc/verify.h"
+#include "../inc/server.h"
+#include "../inc/latency.h"
+#include "../inc/witness.h"
+#include "../inc/sampling.h"
+#include "../inc/portfolio.h"
+#include "../inc/canonical.h"
+#include "../inc/partition.h"
+#include "../inc/profile.h"
+#include "../inc/pipeline.h"
+
+// Append the slowest tasksets of a sweep cell to the slowest tasksets file
+
+static void print_slowest_tasksets (FILE *slowest_fptr, double criticality_proportion, double taskset_utilization, const char *algorithm, const LatencyStats *latency_stats) {
+
+    for (int i = 0; i < latency_stats->num_slowest; i++)
+        fprintf(slowest_fptr, "%lf,%lf,%s,%d,%lf,%Lf,%lld,%lld\n", criticality_proportion, taskset_utilization, algorithm, i + 1, latency_stats->slowest[i].latency / 1e3, latency_stats->slowest[i].interval_length, latency_stats->slowest[i].t_points, latency_stats->slowest[i].t_s_points);
+}
+
+// Benchmark the processor demand kernels and the descent strategies of MC-QPA on generated tasksets: time per (t, s) point and speedup over
+// the generic kernel (every kernel and strategy analyses the same tasksets)
+
+static void run_kernel_benchmark (FILE *output_fptr) {
+
+    const int sizes[KERNEL_BENCH_NUM_SIZES] = KERNEL_BENCH_SIZES;
+    const double proportions[KERNEL_BENCH_NUM_PROPORTIONS] = KERNEL_BENCH_PROPORTIONS;
+    const double utilizations[KERNEL_BENCH_NUM_PROPORTIONS] = KERNEL_BENCH_UTILIZATIONS;
+    const char *kernel_names[NUM_KERNELS + 1] = {"Auto", "Generic", "Partitioned", "All-LO", "All-HI"};
+    const char *descent_names[NUM_DESCENT_STRATEGIES] = DESCENT_NAMES;
+
+    Tasks *tasksets[KERNEL_BENCH_NUM_TASKSETS];    // Tasksets of the benchmark cell (shared by all kernels)
+    Schedulability generic_results[KERNEL_BENCH_NUM_TASKSETS];    // Results of the generic kernel, reference verdicts
+    Schedulability schedulability;                 // Result of the kernel being benchmarked
+    Workspace workspace;                           // Scratch memory of MC-QPA, kept warm across tasksets
+    long long int kernel_time = 0;                 // CPU time (ns) taken by the kernel on the tasksets it applies to
+    long long int generic_time = 0;                // CPU time (ns) taken by the generic kernel on the same tasksets
+    long long int t_points = 0;                    // Number of t points checked by the kernel on the tasksets it applies to
+    long long int t_s_points = 0;                  // Number of (t, s) points checked by the kernel on the tasksets it applies to
+    long long int start = 0;                       // Start time (ns) of the last test run
+    long long int generic_times[KERNEL_BENCH_NUM_TASKSETS];    // CPU time (ns) taken by the generic kernel on each taskset
+    int num_applied = 0;                           // Number of tasksets the kernel applies to
+    int num_mismatches = 0;                        // Number of tasksets on which the kernel and the generic kernel disagree
+
+    init_workspace(&workspace);
+    srand(time(0));
+
+    fprintf(output_fptr, "Tasks,Criticality Proportion,Descent,Kernel,Tasksets,Test time,Interval lengths,Pair-points,Time per pair-point (ns),Speedup over generic,Mismatches\n");
+
+    for (int ni = 0; ni < KERNEL_BENCH_NUM_SIZES; ni++) {
+        for (int pi = 0; pi < KERNEL_BENCH_NUM_PROPORTIONS; pi++) {
+
+            printf("\n Tasks: %d\t Criticality Proportion: %lf\n", sizes[ni], proportions[pi]);
+
+            // Generate the tasksets and run the generic kernel (reference verdicts and times)
+            for (int k = 0; k < KERNEL_BENCH_NUM_TASKSETS; k++) {
+                tasksets[k] = malloc(sizes[ni] * sizeof(Tasks));
+                task_parameter_generator(tasksets[k], sizes[ni], utilizations[pi], proportions[pi]);
+                start = get_cpu_time_ns();
+                schedulability_test_mcqpa_kernel(tasksets[k], sizes[ni], MCQPA_DESCENT, KERNEL_GENERIC, &generic_results[k], &workspace);
+                generic_times[k] = get_cpu_time_ns() - start;
+            }
+
+            // Run every kernel, on the tasksets it applies to
+            for (int kernel = KERNEL_GENERIC; kernel < NUM_KERNELS + 1; kernel++) {
+
+                kernel_time = 0;
+                generic_time = 0;
+                t_points = 0;
+                t_s_points = 0;
+                num_applied = 0;
+                num_mismatches = 0;
+
+                for (int k = 0; k < KERNEL_BENCH_NUM_TASKSETS; k++) {
+
+                    // The automatic selection is benchmarked last
+                    start = get_cpu_time_ns();
+                    schedulability_test_mcqpa_kernel(tasksets[k], sizes[ni], MCQPA_DESCENT, (kernel == NUM_KERNELS) ? KERNEL_AUTO : kernel, &schedulability, &workspace);
+                    start = get_cpu_time_ns() - start;
+
+                    // Skip the tasksets on which the kernel does not apply (the generic kernel was used instead, e.g. Max{U_HI, U_LO} >= 1.0)
+                    if (kernel != NUM_KERNELS && schedulability.kernel != kernel)
+                        continue;
+
+                    num_applied++;
+                    kernel_time += start;
+                    generic_time += generic_times[k];
+                    t_points += schedulability.t_points;
+                    t_s_points += schedulability.t_s_points;
+                    num_mismatches += (schedulability.taskset_schedulability != generic_results[k].taskset_schedulability);
+                }
+
+                if (num_applied == 0)
+                    continue;
+
+                printf(" %s\t %s\t Tasksets: %d\t Test time: %lf\t Interval lengths: %lld\t Pair-points: %lld\t Time per pair-point (ns): %lf\t Speedup over generic: %lf\t Mismatches: %d\n", descent_names[MCQPA_DESCENT], kernel_names[(kernel == NUM_KERNELS) ? 0 : kernel + 1],
+                       num_applied, kernel_time / 1e9, t_points, t_s_points, (t_s_points > 0) ? kernel_time / (double)t_s_points : 0.0, (kernel_time > 0) ? generic_time / (double)kernel_time : 0.0, num_mismatches);
+                fprintf(output_fptr, "%d,%lf,%s,%s,%d,%lf,%lld,%lld,%lf,%lf,%d\n", sizes[ni], proportions[pi], descent_names[MCQPA_DESCENT], kernel_names[(kernel == NUM_KERNELS) ? 0 : kernel + 1],
+                        num_applied, kernel_time / 1e9, t_points, t_s_points, (t_s_points > 0) ? kernel_time / (double)t_s_points : 0.0, (kernel_time > 0) ? generic_time / (double)kernel_time : 0.0, num_mismatches);
+                fflush(output_fptr);
+            }
+
+            // Run every descent strategy with the automatic kernel selection, on all tasksets
+            for (int descent = 0; descent < NUM_DESCENT_STRATEGIES; descent++) {
+
+                kernel_time = 0;
+                generic_time = 0;
+                t_points = 0;
+                t_s_points = 0;
+                num_mismatches = 0;
+
+                for (int k = 0; k < KERNEL_BENCH_NUM_TASKSETS; k++) {
+                    start = get_cpu_time_ns();
+                    schedulability_test_mcqpa_kernel(tasksets[k], sizes[ni], descent, KERNEL_AUTO, &schedulability, &workspace);
+                    kernel_time += get_cpu_time_ns() - start;
+                    generic_time += generic_times[k];
+                    t_points += schedulability.t_points;
+                    t_s_points += schedulability.t_s_points;
+                    num_mismatches += (schedulability.taskset_schedulability != generic_results[k].taskset_schedulability);
+                }
+
+                printf(" %s\t %s\t Tasksets: %d\t Test time: %lf\t Interval lengths: %lld\t Pair-points: %lld\t Time per pair-point (ns): %lf\t Speedup over generic: %lf\t Mismatches: %d\n", descent_names[descent], kernel_names[0],
+                       KERNEL_BENCH_NUM_TASKSETS, kernel_time / 1e9, t_points, t_s_points, (t_s_points > 0) ? kernel_time / (double)t_s_points : 0.0, (kernel_time > 0) ? generic_time / (double)kernel_time : 0.0, num_mismatches);
+                fprintf(output_fptr, "%d,%lf,%s,%s,%d,%lf,%lld,%lld,%lf,%lf,%d\n", sizes[ni], proportions[pi], descent_names[descent], kernel_names[0],
+                        KERNEL_BENCH_NUM_TASKSETS, kernel_time / 1e9, t_points, t_s_points, (t_s_points > 0) ? kernel_time / (double)t_s_points : 0.0, (kernel_time > 0) ? generic_time / (double)kernel_time : 0.0, num_mismatches);
+                fflush(output_fptr);
+            }
+
+            for (int k = 0; k < KERNEL_BENCH_NUM_TASKSETS; k++)
+                free(tasksets[k]);
+        }
+    }
+
+    free_workspace(&workspace);
+}
 
 int main(int argc, char* argv[]) {
 
     // Time variables
-    clock_t t1, t2;                                // To store the number of clock ticks elapsed
     double time_taken_1 = 0.0;                     // Records the time taken by the EDF schedulability test with QPA optimization
     double time_taken_2 = 0.0;                     // Records the time taken by the EDF schedulability test without QPA optimization
+    double time_taken_3 = 0.0;                     // Records the time taken by the approximate EDF schedulability test
+    LatencyStats *latency_stats;                   // Per-taskset latency distribution and slowest tasksets of the Iterative test
+    LatencyStats *latency_stats_mcqpa;             // Per-taskset latency distribution and slowest tasksets of MC-QPA
+    LatencyStats *latency_stats_approx;            // Per-taskset latency distribution and slowest tasksets of the Approximate test
+    double time_taken_4 = 0.0;                     // Records the wall-clock time taken by the portfolio of Iterative and MC-QPA
+    LatencyStats *latency_stats_portfolio;         // Per-taskset wall-clock latency distribution and slowest tasksets of the portfolio
+    double time_taken_5 = 0.0;                     // Records the time taken by MC-QPA on the tasksets as given (before canonicalization)
 
     // Taskset generation variables
     Tasks *tasks;                                  // Pointer to task structure array
     int num_tasks = 0;                             // Number of tasks in the taskset (file input)
     int num_tasksets = 0;                          // Number of tasksets generated / read
+    int num_canonical_tasks = 0;                   // Number of tasks in the canonical taskset
+    long long int sum_num_tasks = 0;               // Total number of tasks before canonicalization
+    long long int sum_num_canonical_tasks = 0;     // Total number of tasks after canonicalization
 
     // Schedulability result structs
     Schedulability *schedulability;                // Schedulability struct for iterative test
     Schedulability *schedulability_mcqpa;          // Schedulability struct for MC-QPA
+    Schedulability *schedulability_approx;         // Schedulability struct for the Approximate test
+    Schedulability *schedulability_portfolio;      // Schedulability struct for the portfolio (verdict of the winning test)
+    Schedulability *schedulability_raw;            // Schedulability struct for MC-QPA on the taskset as given (before canonicalization)
+
+    // Pipeline variables (input methods 'f' and 't')
+    Pipeline pipeline;                             // Generator / reader, prefilter and exact-test worker threads
+    PipelineItem *item;                            // Analysed taskset, with the results of every test
+    int cell = 0;                                  // Index of the current sweep cell (input method 't')
 
     // Output print variables
     long long int num_t_s, num_t_s_mcqpa = 0;      // Total number of (t, s) points verified for NUM_TASKSETS tasksets
     long long int num_t, num_t_mcqpa = 0;          // Total number of t points verified for NUM_TASKSETS tasksets
+    long long int num_t_s_approx = 0;              // Total number of (t, s) points verified by the Approximate test (including fallbacks)
+    long long int num_t_approx = 0;                // Total number of t points verified by the Approximate test (including fallbacks)
+    int num_fallbacks = 0;                         // Number of tasksets on which the Approximate test fell back on MC-QPA
+    long long int num_t_s_raw = 0;                 // Total number of (t, s) points verified by MC-QPA on the tasksets as given
     long double av_t = 0;                          // Average interval length over which the schedulability is ensured for NUM_TASKSETS tasksets
     int num_failed_tasksets = 0;                   // Total number of tasksets that fail the schedulability test
     int failed_case1 = 0;                          // Number of tasksets that fail the schedulability test at t < (upper bound) / 2
     int failed_case2 = 0;                          // Number of tasksets that fail the schedulability test at t < (upper bound) / 4
+    long long int peak_memory = 0;                 // Peak memory (in bytes) allocated by the Iterative test for a single taskset
+    long long int peak_memory_mcqpa = 0;           // Peak memory (in bytes) allocated by MC-QPA for a single taskset
+
+    // Verification variables
+    Verification verification;                     // Decides which MC-QPA verdicts are cross-checked against the Iterative test
+    int verified = 0;                              // Set to 1 if the current taskset was cross-checked by the Iterative test
+    int num_verified = 0;                          // Number of tasksets cross-checked by the Iterative test
+    int num_mismatches = 0;                        // Number of cross-checked tasksets on which both tests disagree
+
+    // Witness-first re-testing variables
+    int num_witness_hits = 0;                      // Number of tasksets rejected by one of the witnesses of the previous tasksets
 
     // Weighted schedulability variables
     double taskset_util = 0.0;                     // Taskset utilization
@@ -36,19 +202,64 @@ int main(int argc, char* argv[]) {
     double sum_schedulable_taskset_utils = 0.0;    // Sum of all SCHEDULABLE taskset utilizations
     double weighted_schedulability = 0.0;          // Weighted Schedulability = (Sum of all SCHEDULABLE taskset utilizations) / (Sum of all taskset utilizations)
 
+    // Sampling variables (input method 't')
+    Sampling sampling;                             // Running weighted schedulability sums, decides when a sweep cell has enough tasksets
+    long long int total_samples = 0;               // Number of tasksets generated over the whole sweep
+    long long int sweep_time = 0;                  // Wall-clock time (ns) taken by the whole sweep (the tests run on the pipeline threads)
+
+    // Common random numbers variables (input method 't', SWEEP_CRN)
+    long long int num_t_cached = 0;                // Total number of t points at which MC-QPA read S(t) from the job lattice
+
+    // Profiling variables (input method 't', PROFILING)
+    Profiler profiler;                                     // Performance counters of the calling thread (to list the available counters)
+    ProfileStats profile_stats;                            // Performance counters of the Iterative test over the sweep cell
+    ProfileStats profile_stats_mcqpa;                      // Performance counters of MC-QPA over the sweep cell
+
+    // Portfolio variables
+    int winner = 0;                                // Test that gave the portfolio verdict on the current taskset (PORTFOLIO_ITERATIVE or PORTFOLIO_MCQPA)
+    int num_wins[PORTFOLIO_NUM_TESTS];             // Number of tasksets won by each test of the portfolio
+
     // Precondition check
-    assert((argc == 2) && (*argv[1] == 'f' || *argv[1] == 'F' || *argv[1] == 't' || *argv[1] == 'T') && "Program expects the following two arguments: <executable name> <input method> (see README for further details)");
+    assert((argc == 2 || (argc == 3 && (*argv[1] == 's' || *argv[1] == 'S'))) && (*argv[1] == 'f' || *argv[1] == 'F' || *argv[1] == 't' || *argv[1] == 'T' || *argv[1] == 's' || *argv[1] == 'S' || *argv[1] == 'b' || *argv[1] == 'B' || *argv[1] == 'p' || *argv[1] == 'P' || *argv[1] == 'k' || *argv[1] == 'K') && "Program expects the following two arguments: <executable name> <input method> (see README for further details)");
+
+    // Serve analysis requests on the given Unix domain socket, or on stdin/stdout if no socket path is given
+    if (*argv[1] == 's' || *argv[1] == 'S') {
+        run_server((argc == 3) ? argv[2] : NULL);
+        return 0;
+    }
 
     // Open output file
     FILE *output_fptr;
     output_fptr = fopen("output.csv","w+");
     assert(output_fptr != NULL && "Error opening the output file \"output.csv\"");
 
-    schedulability = malloc(sizeof(Schedulability));
-    schedulability_mcqpa = malloc(sizeof(Schedulability));
+    latency_stats = malloc(sizeof(LatencyStats));
+    latency_stats_mcqpa = malloc(sizeof(LatencyStats));
+    latency_stats_approx = malloc(sizeof(LatencyStats));
+    init_latency_stats(latency_stats);
+    init_latency_stats(latency_stats_mcqpa);
+    init_latency_stats(latency_stats_approx);
+    latency_stats_portfolio = malloc(sizeof(LatencyStats));
+    init_latency_stats(latency_stats_portfolio);
+
+    init_verification(&verification, (unsigned int)time(0));
+    num_wins[PORTFOLIO_ITERATIVE] = 0;
+    num_wins[PORTFOLIO_MCQPA] = 0;
+
+    // Benchmark the analysis server latency and throughput at different request rates
+    if (*argv[1] == 'b' || *argv[1] == 'B')
+        run_server_benchmark(output_fptr);
+
+    // Partition generated tasksets onto multiple cores with every heuristic and task order
+    else if (*argv[1] == 'p' || *argv[1] == 'P')
+        run_partition_sweep(output_fptr);
+
+    // Benchmark the specialized processor demand kernels of MC-QPA against the generic one
+    else if (*argv[1] == 'k' || *argv[1] == 'K')
+        run_kernel_benchmark(output_fptr);
 
     // Simulate tests for custom inputs via files
-    if (*argv[1] == 'f' || *argv[1] == 'F') {
+    else if (*argv[1] == 'f' || *argv[1] == 'F') {
 
         // Open input file
         FILE *input_fptr;
@@ -59,37 +270,97 @@ int main(int argc, char* argv[]) {
         fscanf(input_fptr,"%d\n", &num_tasksets);
 
         // Print output file headings
-        fprintf(output_fptr, ",Schedulability,Iterative test time,MC-QPA test time,Iterative interval lengths,MC-QPA interval lengths,Iterative pair-points,MC-QPA pair-points\n");
+        fprintf(output_fptr, ",Schedulability,Verified,Mismatch,Iterative test time,MC-QPA test time,Iterative interval lengths,MC-QPA interval lengths,Iterative pair-points,MC-QPA pair-points,Iterative peak memory (bytes),MC-QPA peak memory (bytes),Witness hit,Witness t,Witness s,Witness demand,Tasks,Canonical tasks");
+        if (CANONICAL_COMPARE)
+            fprintf(output_fptr, ",MC-QPA (raw) test time,MC-QPA (raw) pair-points");
+        if (APPROX_TEST)
+            fprintf(output_fptr, ",Approximate test time,Approximate interval lengths,Approximate pair-points,Approximate fallback");
+        if (PORTFOLIO)
+            fprintf(output_fptr, ",Portfolio winner,Portfolio test time");
+        fprintf(output_fptr, "\n");
+
+        // Read, prefilter and analyse the tasksets on the pipeline threads, the results arrive in file order
+        init_pipeline(&pipeline, 'f', input_fptr, num_tasksets, (unsigned int)time(0));
 
         // For each taskset
         for (int i = 0; i < num_tasksets; i++) {
 
-            // Fetch task parameters
-            fscanf(input_fptr,"%d\n", &num_tasks);
-            tasks = malloc(num_tasks * sizeof(Tasks));
-            fetch_task_parameters(input_fptr, tasks, num_tasks);
+            // Get the next analysed taskset, all tests analysed the canonical taskset
+            item = next_pipeline_item(&pipeline, 0);
+            assert(item != NULL);
+            tasks = item->tasks;
+            num_tasks = item->num_tasks;
+            num_canonical_tasks = item->num_canonical_tasks;
+            schedulability = &item->schedulability;
+            schedulability_mcqpa = &item->schedulability_mcqpa;
+            schedulability_approx = &item->schedulability_approx;
+            schedulability_portfolio = &item->schedulability_portfolio;
+            schedulability_raw = &item->schedulability_raw;
+            sum_num_tasks += num_tasks;
+            sum_num_canonical_tasks += num_canonical_tasks;
+
+            // MC-QPA on the taskset as given, to measure the effect of canonicalization (same verdict expected)
+            if (CANONICAL_COMPARE) {
+                time_taken_5 += item->t5 / 1e9;
+                num_mismatches += check_verdicts(&verification, "MC-QPA (raw)", tasks, num_tasks, schedulability_raw, schedulability_mcqpa);
+            }
 
-            // Run Iterative test (Algorithm 1)
-            t1 = clock();
-            schedulability_test(tasks, num_tasks, schedulability);
-            t1 = clock() - t1;
-            time_taken_1 += ((double)t1) / CLOCKS_PER_SEC;
+            // MC-QPA test (Algorithm 2), with the violation witnesses of the previous tasksets checked first (the tasksets decided by the prefilter were not timed)
+            time_taken_2 += item->t2 / 1e9;
+            if (!item->prefiltered)
+                record_latency(latency_stats_mcqpa, item->t2, schedulability_mcqpa);
+            num_witness_hits += schedulability_mcqpa->witness_hit;
+
+            // Approximate test (exact overall: falls back on MC-QPA when inconclusive)
+            if (APPROX_TEST) {
+                time_taken_3 += item->t3 / 1e9;
+                if (!item->prefiltered)
+                    record_latency(latency_stats_approx, item->t3, schedulability_approx);
+                num_fallbacks += schedulability_approx->approx_fallback;
+                num_mismatches += check_verdicts(&verification, "Approximate", tasks, num_tasks, schedulability_approx, schedulability_mcqpa);
+            }
+
+            // Portfolio of Iterative and MC-QPA (wall-clock time: the tests run on two threads)
+            if (PORTFOLIO) {
+                winner = item->winner;
+                time_taken_4 += item->t4 / 1e9;
+                if (!item->prefiltered)
+                    record_latency(latency_stats_portfolio, item->t4, schedulability_portfolio);
+                num_wins[winner]++;
+                num_mismatches += check_verdicts(&verification, "Portfolio", tasks, num_tasks, schedulability_portfolio, schedulability_mcqpa);
+            }
 
-            // Run MC-QPA test (Algorithm 2)
-            t2 = clock();
-            schedulability_test_mcqpa(tasks, num_tasks, schedulability_mcqpa);
-            t2 = clock() - t2;
-            time_taken_2 += ((double)t2) / CLOCKS_PER_SEC;
+            // Iterative test (Algorithm 1), run only if the verification policy of the worker selected this taskset
+            verified = item->verified;
+            if (verified) {
+                time_taken_1 += item->t1 / 1e9;
+                record_latency(latency_stats, item->t1, schedulability);
 
-            // Experimentally confirms the correctness of MC-QPA
-            assert(schedulability->taskset_schedulability == schedulability_mcqpa->taskset_schedulability);
+                // Experimentally confirms the correctness of MC-QPA, mismatches are logged instead of aborting the run
+                num_verified++;
+                num_mismatches += check_verdicts(&verification, "Iterative", tasks, num_tasks, schedulability, schedulability_mcqpa);
+            }
 
             // Print outputs
-            printf(" For taskset %d\t Schedulability: %d\t Iterative test time: %lf\t MC-QPA test time: %lf\t Iterative interval lengths: %lld\t MC-QPA interval lengths: %lld\t Iterative pair-points:%lld\t MC-QPA pair-points: %lld\n", i + 1, schedulability->taskset_schedulability, time_taken_1, time_taken_2, schedulability->t_points, schedulability_mcqpa->t_points, schedulability->t_s_points, schedulability_mcqpa->t_s_points);
-            fprintf(output_fptr, "Taskset %d,%d,%lf,%lf,%lld,%lld,%lld,%lld\n", i + 1, schedulability->taskset_schedulability, time_taken_1, time_taken_2, schedulability->t_points, schedulability_mcqpa->t_points, schedulability->t_s_points, schedulability_mcqpa->t_s_points);
+            printf(" For taskset %d\t Schedulability: %d\t Verified: %d\t Iterative test time: %lf\t MC-QPA test time: %lf\t Iterative interval lengths: %lld\t MC-QPA interval lengths: %lld\t Iterative pair-points:%lld\t MC-QPA pair-points: %lld\t Iterative peak memory: %lld\t MC-QPA peak memory: %lld\t Witness hit: %d\t Witness (t, s, demand): (%lld, %lld, %lf)\t Tasks: %d (%d canonical)", i + 1, schedulability_mcqpa->taskset_schedulability, verified, time_taken_1, time_taken_2, schedulability->t_points, schedulability_mcqpa->t_points, schedulability->t_s_points, schedulability_mcqpa->t_s_points, schedulability->peak_memory, schedulability_mcqpa->peak_memory, schedulability_mcqpa->witness_hit, schedulability_mcqpa->witness.t, schedulability_mcqpa->witness.s, schedulability_mcqpa->witness.demand, num_tasks, num_canonical_tasks);
+            fprintf(output_fptr, "Taskset %d,%d,%d,%d,%lf,%lf,%lld,%lld,%lld,%lld,%lld,%lld,%d,%lld,%lld,%lf,%d,%d", i + 1, schedulability_mcqpa->taskset_schedulability, verified, verified && (schedulability->taskset_schedulability != schedulability_mcqpa->taskset_schedulability), time_taken_1, time_taken_2, schedulability->t_points, schedulability_mcqpa->t_points, schedulability->t_s_points, schedulability_mcqpa->t_s_points, schedulability->peak_memory, schedulability_mcqpa->peak_memory, schedulability_mcqpa->witness_hit, schedulability_mcqpa->witness.t, schedulability_mcqpa->witness.s, schedulability_mcqpa->witness.demand, num_tasks, num_canonical_tasks);
+            if (CANONICAL_COMPARE) {
+                printf("\t MC-QPA (raw) test time: %lf\t MC-QPA (raw) pair-points: %lld", time_taken_5, schedulability_raw->t_s_points);
+                fprintf(output_fptr, ",%lf,%lld", time_taken_5, schedulability_raw->t_s_points);
+            }
+            if (APPROX_TEST) {
+                printf("\t Approximate test time: %lf\t Approximate interval lengths: %lld\t Approximate pair-points: %lld\t Approximate fallback: %d", time_taken_3, schedulability_approx->t_points, schedulability_approx->t_s_points, schedulability_approx->approx_fallback);
+                fprintf(output_fptr, ",%lf,%lld,%lld,%d", time_taken_3, schedulability_approx->t_points, schedulability_approx->t_s_points, schedulability_approx->approx_fallback);
+            }
+            if (PORTFOLIO) {
+                printf("\t Portfolio winner: %s\t Portfolio test time: %lf", (winner == PORTFOLIO_ITERATIVE) ? "Iterative" : "MC-QPA", time_taken_4);
+                fprintf(output_fptr, ",%s,%lf", (winner == PORTFOLIO_ITERATIVE) ? "Iterative" : "MC-QPA", time_taken_4);
+            }
+            printf("\n");
+            fprintf(output_fptr, "\n");
 
-            // Get the taskset utilization
-            taskset_util = get_taskset_utilization(tasks, num_tasks);
+            // Get the taskset utilization (computed by the prefilter)
+            taskset_util = item->taskset_util;
 
             // Update sum of all taskset utilizations
             sum_taskset_utils += taskset_util;
@@ -99,9 +370,12 @@ int main(int argc, char* argv[]) {
                 sum_schedulable_taskset_utils += taskset_util;
 
             // Free allocated memory
-            free(tasks);
+            free_pipeline_item(item);
         }
 
+        // Stop the pipeline threads
+        free_pipeline(&pipeline);
+
         // Calculate weighted schedulability
         if (sum_taskset_utils != 0.0)
             weighted_schedulability = sum_schedulable_taskset_utils / sum_taskset_utils;
@@ -109,8 +383,32 @@ int main(int argc, char* argv[]) {
             weighted_schedulability = 0.0;
 
         // Print outputs
-        fprintf(output_fptr,"\n Weighted Schedulability: %lf\n", weighted_schedulability);
-        printf("\n Weighted schedulability: %lf\n", weighted_schedulability);
+        fprintf(output_fptr,"\n Weighted Schedulability: %lf\n Verified tasksets: %d\n Mismatches: %d\n Witness hits: %d\n Tasks: %lld (%lld canonical)\n", weighted_schedulability, num_verified, num_mismatches, num_witness_hits, sum_num_tasks, sum_num_canonical_tasks);
+        printf("\n Weighted schedulability: %lf\t Verified tasksets: %d\t Mismatches: %d\t Witness hits: %d\t Tasks: %lld (%lld canonical)\n", weighted_schedulability, num_verified, num_mismatches, num_witness_hits, sum_num_tasks, sum_num_canonical_tasks);
+        if (APPROX_TEST) {
+            fprintf(output_fptr," Approximate fallback rate: %lf\n", (num_tasksets > 0) ? num_fallbacks / (double)num_tasksets : 0.0);
+            printf(" Approximate fallback rate: %lf\n", (num_tasksets > 0) ? num_fallbacks / (double)num_tasksets : 0.0);
+        }
+
+        // Print per-taskset latency distributions (us)
+        fprintf(output_fptr, "\n,p50 latency (us),p90 latency (us),p99 latency (us),Max latency (us)\n");
+        fprintf(output_fptr, "Iterative,%lf,%lf,%lf,%lf\n", get_latency_percentile(latency_stats, 50.0) / 1e3, get_latency_percentile(latency_stats, 90.0) / 1e3, get_latency_percentile(latency_stats, 99.0) / 1e3, get_latency_percentile(latency_stats, 100.0) / 1e3);
+        fprintf(output_fptr, "MC-QPA,%lf,%lf,%lf,%lf\n", get_latency_percentile(latency_stats_mcqpa, 50.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 90.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 99.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 100.0) / 1e3);
+        if (APPROX_TEST)
+            fprintf(output_fptr, "Approximate,%lf,%lf,%lf,%lf\n", get_latency_percentile(latency_stats_approx, 50.0) / 1e3, get_latency_percentile(latency_stats_approx, 90.0) / 1e3, get_latency_percentile(latency_stats_approx, 99.0) / 1e3, get_latency_percentile(latency_stats_approx, 100.0) / 1e3);
+        if (PORTFOLIO) {
+            fprintf(output_fptr, "Portfolio,%lf,%lf,%lf,%lf\n", get_latency_percentile(latency_stats_portfolio, 50.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 90.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 99.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 100.0) / 1e3);
+            fprintf(output_fptr, "\n Portfolio wins: %d (Iterative), %d (MC-QPA)\n", num_wins[PORTFOLIO_ITERATIVE], num_wins[PORTFOLIO_MCQPA]);
+        }
+        printf(" Iterative latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", get_latency_percentile(latency_stats, 50.0) / 1e3, get_latency_percentile(latency_stats, 90.0) / 1e3, get_latency_percentile(latency_stats, 99.0) / 1e3, get_latency_percentile(latency_stats, 100.0) / 1e3);
+        printf(" MC-QPA latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", get_latency_percentile(latency_stats_mcqpa, 50.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 90.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 99.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 100.0) / 1e3);
+        if (APPROX_TEST)
+            printf(" Approximate latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", get_latency_percentile(latency_stats_approx, 50.0) / 1e3, get_latency_percentile(latency_stats_approx, 90.0) / 1e3, get_latency_percentile(latency_stats_approx, 99.0) / 1e3, get_latency_percentile(latency_stats_approx, 100.0) / 1e3);
+        if (PORTFOLIO)
+            printf(" Portfolio latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\t Portfolio wins: %d (Iterative), %d (MC-QPA)\n", get_latency_percentile(latency_stats_portfolio, 50.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 90.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 99.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 100.0) / 1e3, num_wins[PORTFOLIO_ITERATIVE], num_wins[PORTFOLIO_MCQPA]);
+
+        // Print the utilization of every pipeline stage
+        print_pipeline_stats(&pipeline, output_fptr);
 
         // Close the input file
         fclose(input_fptr);
@@ -119,14 +417,46 @@ int main(int argc, char* argv[]) {
     // Simulate tests on tasksets generated using the task parameter generator function
     else if (*argv[1] == 't' || *argv[1] == 'T') {
 
+        // Open the slowest tasksets file
+        FILE *slowest_fptr;
+        slowest_fptr = fopen(SLOWEST_FILE, "w+");
+        assert(slowest_fptr != NULL && "Error opening the output file \"" SLOWEST_FILE "\"");
+        fprintf(slowest_fptr, "Criticality Proportion,Taskset Utilization,Algorithm,Rank,Latency (us),B,Interval lengths,Pair-points\n");
+
+        // Open the performance counters and the profile file
+        FILE *profile_fptr = NULL;
+        if (PROFILING) {
+            profile_fptr = fopen(PROFILE_FILE, "w+");
+            assert(profile_fptr != NULL && "Error opening the output file \"" PROFILE_FILE "\"");
+            print_profile_header(profile_fptr);
+
+            // Print the available counters (terminal), the workers open their own counters
+            const char *counter_names[PROFILE_NUM_COUNTERS] = PROFILE_COUNTER_NAMES;
+            init_profiler(&profiler);
+            printf(" Performance counters:");
+            for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+                printf(" %s (%s)", counter_names[counter], profiler_counter_available(&profiler, counter) ? "available" : "n/a");
+            printf("\n");
+            free_profiler(&profiler);
+        }
+
+        // Generate, prefilter and analyse the tasksets of every sweep cell on the pipeline threads, the results arrive in generation order
+        sweep_time = get_wall_time_ns();
+        init_pipeline(&pipeline, 't', NULL, 0, (unsigned int)time(0));
+
         // For criticality proportions 0.25 to 0.75 (step: 0.25)
         for (double criticality_proportion = 0.25; criticality_proportion <= 0.99; criticality_proportion += 0.25) {
 
-            srand(time(0));
-
             // Print output file headings
             fprintf(output_fptr,"\nCriticality Proportion: %lf\n", criticality_proportion);
-            fprintf(output_fptr, "Taskset Utilization,Weighted Schedulability,Iterative test time,MC-QPA test time,Av T upper bound,Iterative interval lengths,MC-QPA interval lengths,Iterative pair-points,MC-QPA pair-points,Number of tasksets failed,Failed before t < 0.5B,Failed before t < 0.25B\n");
+            fprintf(output_fptr, "Taskset Utilization,Weighted Schedulability,Iterative test time,MC-QPA test time,Av T upper bound,Iterative interval lengths,MC-QPA interval lengths,Iterative pair-points,MC-QPA pair-points,Number of tasksets failed,Failed before t < 0.5B,Failed before t < 0.25B,Verified tasksets,Mismatches,Iterative peak memory (bytes),MC-QPA peak memory (bytes),Iterative p50 latency (us),Iterative p90 latency (us),Iterative p99 latency (us),Iterative max latency (us),MC-QPA p50 latency (us),MC-QPA p90 latency (us),MC-QPA p99 latency (us),MC-QPA max latency (us),Iterative slowest B,Iterative slowest pair-points,MC-QPA slowest B,MC-QPA slowest pair-points,Samples,Weighted Schedulability CI half-width,Av tasks,Av canonical tasks,MC-QPA time per pair-point (ns),MC-QPA cached interval lengths");
+            if (CANONICAL_COMPARE)
+                fprintf(output_fptr, ",MC-QPA (raw) test time,MC-QPA (raw) pair-points,MC-QPA (raw) time per pair-point (ns)");
+            if (APPROX_TEST)
+                fprintf(output_fptr, ",Approximate test time,Approximate interval lengths,Approximate pair-points,Approximate fallback rate,Approximate p50 latency (us),Approximate p90 latency (us),Approximate p99 latency (us),Approximate max latency (us)");
+            if (PORTFOLIO)
+                fprintf(output_fptr, ",Portfolio test time,Portfolio Iterative wins,Portfolio MC-QPA wins,Portfolio p50 latency (us),Portfolio p90 latency (us),Portfolio p99 latency (us),Portfolio max latency (us)");
+            fprintf(output_fptr, "\n");
 
             // Print heading (terminal)
             printf("\n Criticality Proportion: %lf\n", criticality_proportion);
@@ -139,43 +469,113 @@ int main(int argc, char* argv[]) {
                 sum_schedulable_taskset_utils = 0.0;
                 time_taken_1 = 0.0;
                 time_taken_2 = 0.0;
+                time_taken_3 = 0.0;
+                time_taken_4 = 0.0;
+                time_taken_5 = 0.0;
+                num_t_s_raw = 0;
+                sum_num_tasks = 0;
+                sum_num_canonical_tasks = 0;
+                num_wins[PORTFOLIO_ITERATIVE] = 0;
+                num_wins[PORTFOLIO_MCQPA] = 0;
                 av_t = 0.0;
                 num_t_s = 0;
                 num_t = 0;
                 num_t_s_mcqpa = 0;
                 num_t_mcqpa = 0;
+                num_t_cached = 0;
+                num_t_s_approx = 0;
+                num_t_approx = 0;
+                num_fallbacks = 0;
                 num_failed_tasksets = 0;
                 failed_case1 = 0;
                 failed_case2 = 0;
                 num_tasksets = 0;
-
-                while (num_tasksets < NUM_TASKSETS) {
-
-                    // Generate input tasksets
-                    tasks = malloc(NUM_TASKS * sizeof(Tasks));
-                    tasks = task_parameter_generator(tasks, NUM_TASKS, taskset_utilization, criticality_proportion);
+                num_verified = 0;
+                num_mismatches = 0;
+                peak_memory = 0;
+                peak_memory_mcqpa = 0;
+                init_latency_stats(latency_stats);
+                init_latency_stats(latency_stats_mcqpa);
+                init_latency_stats(latency_stats_approx);
+                init_latency_stats(latency_stats_portfolio);
+                init_profile_stats(&profile_stats);
+                init_profile_stats(&profile_stats_mcqpa);
+                init_sampling(&sampling);
+
+                // Aggregate tasksets until the sampling policy is satisfied (NUM_TASKSETS, or a narrow enough confidence interval)
+                while (sampling_required(&sampling)) {
+
+                    // Get the next analysed taskset of the cell, all tests but MC-QPA (raw) analysed the canonical taskset
+                    item = next_pipeline_item(&pipeline, cell);
+                    assert(item != NULL);
+                    tasks = item->tasks;
+                    num_canonical_tasks = item->num_canonical_tasks;
+                    schedulability = &item->schedulability;
+                    schedulability_mcqpa = &item->schedulability_mcqpa;
+                    schedulability_approx = &item->schedulability_approx;
+                    schedulability_portfolio = &item->schedulability_portfolio;
+                    schedulability_raw = &item->schedulability_raw;
                     num_tasksets++;
+                    sum_num_tasks += NUM_TASKS;
+                    sum_num_canonical_tasks += num_canonical_tasks;
+
+                    // MC-QPA on the taskset as given, to measure the effect of canonicalization (same verdict expected)
+                    if (CANONICAL_COMPARE) {
+                        time_taken_5 += item->t5 / 1e9;
+                        num_t_s_raw += schedulability_raw->t_s_points;
+                        num_mismatches += check_verdicts(&verification, "MC-QPA (raw)", tasks, NUM_TASKS, schedulability_raw, schedulability_mcqpa);
+                    }
 
-                    // Run Iterative test (Algorithm 1)
-                    t1 = clock();
-                    schedulability_test(tasks, NUM_TASKS, schedulability);
-                    t1 = clock() - t1;
-                    time_taken_1 += ((double)t1) / CLOCKS_PER_SEC;
+                    // MC-QPA test (Algorithm 2), the tasksets decided by the prefilter were neither timed nor profiled
+                    if (PROFILING && !item->prefiltered)
+                        add_profile_sample(&profile_stats_mcqpa, item->profile_counts_mcqpa, schedulability_mcqpa);
+                    time_taken_2 += item->t2 / 1e9;
+                    if (!item->prefiltered)
+                        record_latency(latency_stats_mcqpa, item->t2, schedulability_mcqpa);
+
+                    // Approximate test (exact overall: falls back on MC-QPA when inconclusive)
+                    if (APPROX_TEST) {
+                        time_taken_3 += item->t3 / 1e9;
+                        if (!item->prefiltered)
+                            record_latency(latency_stats_approx, item->t3, schedulability_approx);
+                        num_t_s_approx += schedulability_approx->t_s_points;
+                        num_t_approx += schedulability_approx->t_points;
+                        num_fallbacks += schedulability_approx->approx_fallback;
+                        num_mismatches += check_verdicts(&verification, "Approximate", tasks, NUM_TASKS, schedulability_approx, schedulability_mcqpa);
+                    }
 
-                    // Run MC-QPA test (Algorithm 2)
-                    t2 = clock();
-                    schedulability_test_mcqpa(tasks, NUM_TASKS, schedulability_mcqpa);
-                    t2 = clock() - t2;
-                    time_taken_2 += ((double)t2) / CLOCKS_PER_SEC;
+                    // Portfolio of Iterative and MC-QPA (wall-clock time: the tests run on two threads)
+                    if (PORTFOLIO) {
+                        time_taken_4 += item->t4 / 1e9;
+                        if (!item->prefiltered)
+                            record_latency(latency_stats_portfolio, item->t4, schedulability_portfolio);
+                        num_wins[item->winner]++;
+                        num_mismatches += check_verdicts(&verification, "Portfolio", tasks, NUM_TASKS, schedulability_portfolio, schedulability_mcqpa);
+                    }
 
-                    // Experimentally confirms the correctness of MC-QPA
-                    assert(schedulability->taskset_schedulability == schedulability_mcqpa->taskset_schedulability);
+                    // Iterative test (Algorithm 1), run only if the verification policy of the worker selected this taskset
+                    if (item->verified) {
+                        if (PROFILING)
+                            add_profile_sample(&profile_stats, item->profile_counts, schedulability);
+                        time_taken_1 += item->t1 / 1e9;
+                        record_latency(latency_stats, item->t1, schedulability);
+
+                        // Experimentally confirms the correctness of MC-QPA, mismatches are logged instead of aborting the sweep
+                        num_verified++;
+                        num_mismatches += check_verdicts(&verification, "Iterative", tasks, NUM_TASKS, schedulability, schedulability_mcqpa);
+
+                        num_t_s += schedulability->t_s_points;
+                        num_t += schedulability->t_points;
+                        if (peak_memory < schedulability->peak_memory)
+                            peak_memory = schedulability->peak_memory;
+                    }
 
-                    // Get the taskset utilization
-                    taskset_util = get_taskset_utilization(tasks, NUM_TASKS);
+                    // Get the taskset utilization (computed by the prefilter)
+                    taskset_util = item->taskset_util;
 
                     // Update sum of all taskset utilizations
                     sum_taskset_utils += taskset_util;
+                    add_sample(&sampling, taskset_util, schedulability_mcqpa->taskset_schedulability == SCHEDULABLE);
 
                     // If the taskset is SCHEDULABLE, update sum of all SCHEDULABLE taskset utilizations
                     if (schedulability_mcqpa->taskset_schedulability == SCHEDULABLE)
@@ -189,16 +589,20 @@ int main(int argc, char* argv[]) {
                     }
 
                     // Update schedulability results
-                    num_t_s += schedulability->t_s_points;
-                    num_t += schedulability->t_points;
                     num_t_s_mcqpa += schedulability_mcqpa->t_s_points;
                     num_t_mcqpa += schedulability_mcqpa->t_points;
+                    num_t_cached += schedulability_mcqpa->cached_t_points;
+                    if (peak_memory_mcqpa < schedulability_mcqpa->peak_memory)
+                        peak_memory_mcqpa = schedulability_mcqpa->peak_memory;
                     av_t = (schedulability_mcqpa->interval_length + (av_t * (num_tasksets - 1))) / (long double)num_tasksets;
                 
                     // Free allocated memory
-                    free(tasks);
+                    free_pipeline_item(item);
                 }
 
+                // The generator may move on to the next cell
+                finish_pipeline_cell(&pipeline, cell++);
+
                 // Calculate weighted schedulability
                 if (sum_taskset_utils != 0.0)
                     weighted_schedulability = sum_schedulable_taskset_utils / sum_taskset_utils;
@@ -206,16 +610,80 @@ int main(int argc, char* argv[]) {
                     weighted_schedulability = 0.0;
 
                 // Print weighted schedulability info
-                printf(" Taskset Utilization: %lf\t Weighted schedulability: %lf\t Iterative test time: %lf\t MC-QPA test time: %lf\t Tasksets failed: %d (%d before 0.5B, %d before 0.25B)\n", taskset_utilization, weighted_schedulability, time_taken_1, time_taken_2, num_failed_tasksets, failed_case1, failed_case2);
-                printf(" Av B: %Lf\t Iterative interval lengths: %lld\t MC-QPA interval lengths: %lld\t Iterative pair-points:%lld\t MC-QPA pair-points: %lld\n\n", av_t, num_t, num_t_mcqpa, num_t_s, num_t_s_mcqpa);
-                fprintf(output_fptr, "%lf,%lf,%lf,%lf,%Lf,%lld,%lld,%lld,%lld,%d,%d,%d\n", taskset_utilization, weighted_schedulability, time_taken_1, time_taken_2, av_t, num_t, num_t_mcqpa, num_t_s, num_t_s_mcqpa, num_failed_tasksets, failed_case1, failed_case2);
+                printf(" Taskset Utilization: %lf\t Weighted schedulability: %lf\t Iterative test time: %lf\t MC-QPA test time: %lf\t Tasksets failed: %d (%d before 0.5B, %d before 0.25B)\t Verified: %d\t Mismatches: %d\n", taskset_utilization, weighted_schedulability, time_taken_1, time_taken_2, num_failed_tasksets, failed_case1, failed_case2, num_verified, num_mismatches);
+                printf(" Av B: %Lf\t Iterative interval lengths: %lld\t MC-QPA interval lengths: %lld\t Iterative pair-points:%lld\t MC-QPA pair-points: %lld\t Peak memory: %lld (Iterative), %lld (MC-QPA)\n", av_t, num_t, num_t_mcqpa, num_t_s, num_t_s_mcqpa, peak_memory, peak_memory_mcqpa);
+                printf(" Iterative latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\t MC-QPA latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", get_latency_percentile(latency_stats, 50.0) / 1e3, get_latency_percentile(latency_stats, 90.0) / 1e3, get_latency_percentile(latency_stats, 99.0) / 1e3, get_latency_percentile(latency_stats, 100.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 50.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 90.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 99.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 100.0) / 1e3);
+                if (APPROX_TEST)
+                    printf(" Approximate test time: %lf\t Approximate interval lengths: %lld\t Approximate pair-points: %lld\t Approximate fallback rate: %lf\t Approximate latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", time_taken_3, num_t_approx, num_t_s_approx, num_fallbacks / (double)num_tasksets, get_latency_percentile(latency_stats_approx, 50.0) / 1e3, get_latency_percentile(latency_stats_approx, 90.0) / 1e3, get_latency_percentile(latency_stats_approx, 99.0) / 1e3, get_latency_percentile(latency_stats_approx, 100.0) / 1e3);
+                printf(" Samples: %d\t Weighted schedulability CI half-width: %lf\n", num_tasksets, get_ci_half_width(&sampling));
+                if (PORTFOLIO)
+                    printf(" Portfolio test time: %lf\t Portfolio wins: %d (Iterative), %d (MC-QPA)\t Portfolio latency (us): p50 %lf\t p90 %lf\t p99 %lf\t max %lf\n", time_taken_4, num_wins[PORTFOLIO_ITERATIVE], num_wins[PORTFOLIO_MCQPA], get_latency_percentile(latency_stats_portfolio, 50.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 90.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 99.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 100.0) / 1e3);
+                printf(" Av tasks: %lf (%lf canonical)\t MC-QPA cached interval lengths: %lld\n", sum_num_tasks / (double)num_tasksets, sum_num_canonical_tasks / (double)num_tasksets, num_t_cached);
+                if (CANONICAL_COMPARE)
+                    printf(" MC-QPA (raw) test time: %lf\t MC-QPA (raw) pair-points: %lld\n", time_taken_5, num_t_s_raw);
+                printf("\n");
+                fprintf(output_fptr, "%lf,%lf,%lf,%lf,%Lf,%lld,%lld,%lld,%lld,%d,%d,%d,%d,%d,%lld,%lld,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%Lf,%lld,%Lf,%lld,%d,%lf,%lf,%lf,%lf,%lld", taskset_utilization, weighted_schedulability, time_taken_1, time_taken_2, av_t, num_t, num_t_mcqpa, num_t_s, num_t_s_mcqpa, num_failed_tasksets, failed_case1, failed_case2, num_verified, num_mismatches, peak_memory, peak_memory_mcqpa,
+                        get_latency_percentile(latency_stats, 50.0) / 1e3, get_latency_percentile(latency_stats, 90.0) / 1e3, get_latency_percentile(latency_stats, 99.0) / 1e3, get_latency_percentile(latency_stats, 100.0) / 1e3,
+                        get_latency_percentile(latency_stats_mcqpa, 50.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 90.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 99.0) / 1e3, get_latency_percentile(latency_stats_mcqpa, 100.0) / 1e3,
+                        (latency_stats->num_slowest > 0) ? latency_stats->slowest[0].interval_length : 0.0L, (latency_stats->num_slowest > 0) ? latency_stats->slowest[0].t_s_points : 0,
+                        (latency_stats_mcqpa->num_slowest > 0) ? latency_stats_mcqpa->slowest[0].interval_length : 0.0L, (latency_stats_mcqpa->num_slowest > 0) ? latency_stats_mcqpa->slowest[0].t_s_points : 0,
+                        num_tasksets, get_ci_half_width(&sampling),
+                        sum_num_tasks / (double)num_tasksets, sum_num_canonical_tasks / (double)num_tasksets, (num_t_s_mcqpa > 0) ? time_taken_2 * 1e9 / num_t_s_mcqpa : 0.0, num_t_cached);
+                if (CANONICAL_COMPARE)
+                    fprintf(output_fptr, ",%lf,%lld,%lf", time_taken_5, num_t_s_raw, (num_t_s_raw > 0) ? time_taken_5 * 1e9 / num_t_s_raw : 0.0);
+                if (APPROX_TEST)
+                    fprintf(output_fptr, ",%lf,%lld,%lld,%lf,%lf,%lf,%lf,%lf", time_taken_3, num_t_approx, num_t_s_approx, num_fallbacks / (double)num_tasksets,
+                            get_latency_percentile(latency_stats_approx, 50.0) / 1e3, get_latency_percentile(latency_stats_approx, 90.0) / 1e3, get_latency_percentile(latency_stats_approx, 99.0) / 1e3, get_latency_percentile(latency_stats_approx, 100.0) / 1e3);
+                if (PORTFOLIO)
+                    fprintf(output_fptr, ",%lf,%d,%d,%lf,%lf,%lf,%lf", time_taken_4, num_wins[PORTFOLIO_ITERATIVE], num_wins[PORTFOLIO_MCQPA],
+                            get_latency_percentile(latency_stats_portfolio, 50.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 90.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 99.0) / 1e3, get_latency_percentile(latency_stats_portfolio, 100.0) / 1e3);
+                fprintf(output_fptr, "\n");
+
+                // Record the slowest tasksets of the cell
+                print_slowest_tasksets(slowest_fptr, criticality_proportion, taskset_utilization, "Iterative", latency_stats);
+                print_slowest_tasksets(slowest_fptr, criticality_proportion, taskset_utilization, "MC-QPA", latency_stats_mcqpa);
+                if (APPROX_TEST)
+                    print_slowest_tasksets(slowest_fptr, criticality_proportion, taskset_utilization, "Approximate", latency_stats_approx);
+                if (PORTFOLIO)
+                    print_slowest_tasksets(slowest_fptr, criticality_proportion, taskset_utilization, "Portfolio", latency_stats_portfolio);
+                fflush(slowest_fptr);
+
+                // Record the performance counters of the cell
+                if (PROFILING) {
+                    print_profile_stats(profile_fptr, criticality_proportion, taskset_utilization, "Iterative", &profile_stats);
+                    print_profile_stats(profile_fptr, criticality_proportion, taskset_utilization, "MC-QPA", &profile_stats_mcqpa);
+                    fflush(profile_fptr);
+                }
+
+                total_samples += num_tasksets;
             }
         }
+
+        // Stop the pipeline threads
+        free_pipeline(&pipeline);
+
+        // Print the sweep cost and the utilization of every pipeline stage
+        sweep_time = get_wall_time_ns() - sweep_time;
+        fprintf(output_fptr, "\n Total tasksets: %lld\n Sweep time: %lf\n Base tasksets: %lld\n Job lattice offsets: %lld\n", total_samples, sweep_time / 1e9, pipeline.num_base_tasksets, pipeline.num_offsets);
+        printf(" Total tasksets: %lld\t Sweep time: %lf\t Base tasksets: %lld\t Job lattice offsets: %lld\n", total_samples, sweep_time / 1e9, pipeline.num_base_tasksets, pipeline.num_offsets);
+        print_pipeline_stats(&pipeline, output_fptr);
+
+        // Close the slowest tasksets file
+        fclose(slowest_fptr);
+
+        // Close the profile file
+        if (PROFILING)
+            fclose(profile_fptr);
     }
 
+    // Finalize the mismatch reproducer file
+    close_verification(&verification);
+
     // Free allocated memory
-    free(schedulability);
-    free(schedulability_mcqpa);
+    free(latency_stats);
+    free(latency_stats_mcqpa);
+    free(latency_stats_approx);
+    free(latency_stats_portfolio);
 
     // Close the output file
     fclose(output_fptr);
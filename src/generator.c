@@ -50,7 +50,7 @@ void generate_task_utilizations (Tasks *tasks, int num_tasks, double u_bar, int
     double next_util_sum = 0.0;    // Sum of remaining tasks in the taskset
 
     // Precondition check
-    assert(tasks != NULL && num_tasks > 0 && u_bar > 0.00 && u_bar < 1.00);
+    assert(tasks != NULL && num_tasks > 0 && u_bar > 0.00 && u_bar <= 1.00);
 
     // For the first (n - 1) tasks
     for (int i = 0; i < (num_tasks - 1); i++) {
@@ -191,6 +191,48 @@ Tasks* task_parameter_generator (Tasks *tasks, int num_tasks, double total_utili
     return tasks;
 }
 
+// Base taskset generator (common random numbers)
+
+Tasks* base_taskset_generator (Tasks *tasks, int num_tasks, double criticality_proportion) {
+
+    // Precondition check
+    assert(tasks != NULL && num_tasks > 0 && criticality_proportion >= 0.0 && criticality_proportion < 1.010);
+
+    // Assign a task number to each task structure in the array
+    for (int i = 0; i < num_tasks; i++)
+        tasks[i].task_no = i + 1;
+
+    // Generate individual task parameters in the same order as task_parameter_generator, for a total utilization of 1.0
+    assign_task_criticalities(tasks, num_tasks, criticality_proportion);    // Assign task criticalities
+    generate_task_utilizations(tasks, num_tasks, 1.0, LO);                  // Generate lo-criticality task utilization shares
+    generate_task_periods(tasks, num_tasks);                                // Generate task periods
+    calculate_task_wcets(tasks, num_tasks);                                 // Determine task wcets (fixes the criticality factors)
+    generate_task_deadlines(tasks, num_tasks);                              // Generate task deadlines
+
+    // Return pointer to tasks struct array
+    return tasks;
+}
+
+// Rescale a base taskset to the given total utilization: Ci(X) and Ui(X) are proportional to Ui(LO), the criticality factors are kept
+
+Tasks* scale_taskset (const Tasks *base_tasks, int num_tasks, double total_utilization, Tasks *tasks) {
+
+    // Precondition check
+    assert(base_tasks != NULL && tasks != NULL && num_tasks >= 0 && total_utilization >= 0.0 && total_utilization < 1.0);
+
+    // For all tasks
+    for (int i = 0; i < num_tasks; i++) {
+        tasks[i] = base_tasks[i];
+        tasks[i].wcet[LO] = base_tasks[i].wcet[LO] * total_utilization;
+        tasks[i].wcet[HI] = base_tasks[i].wcet[HI] * total_utilization;
+        tasks[i].utilization[LO] = base_tasks[i].utilization[LO] * total_utilization;
+        tasks[i].utilization[HI] = base_tasks[i].utilization[HI] * total_utilization;
+    }
+
+    // Return pointer to tasks struct array
+    return tasks;
+}
+
 // Fetch task parameters as input from file and stores it in the task structure array
 
 void fetch_task_parameters (FILE* input_file, Tasks *tasks, int num_tasks) {
@@ -6,7 +6,7 @@
 
 // Iterative: Exact EDF schedulability test for 3-parameter sporadic task systems [3] --> Listed as Algorithm 1 in the paper
 
-Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability *schedulability) {
+Schedulability* schedulability_test (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace) {
 
     double lo_util_sum = 0.0;                    // Sum of LO criticality utilizations of all tasks U_LO
     double hi_util_sum = 0.0;                    // Sum of HI criticality utilizations of all tasks U_HI
@@ -14,9 +14,12 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
     double wcet_sum = 0.0;                       // Sum of wcets of all tasks at their own criticality level
     double t_upper_bound = 0.0;                  // [a.k.a. B] Upper bound for t that we need to consider when using DBFi(t, s) for a schedulability test
     long long int floor_t_upper_bound = 0;       // Floor of t upper bound
-    int num_jobs_total = 0;                      // Total number of jobs arriving and having deadlines within floor_t_upper_bound
-    long long int *s_points;                     // [a.k.a. S(t)] s values for which we need to calculate DBFi(t, s), s --> {t - kTi - Di} U {t}
-    int num_s_points = 0;                        // The number of s values in S(t)
+    long long int num_jobs_total = 0;            // Total number of jobs arriving and having deadlines within floor_t_upper_bound
+    long long int *s_points;                     // [a.k.a. S(t)] Chunk of s values for which we need to calculate DBFi(t, s), s --> {t - kTi - Di} U {t}
+    int max_s_points = 0;                        // s points chunk capacity
+    int num_s_points = 0;                        // The number of s values in the current chunk of S(t)
+    SPointsIterator s_points_iterator;           // Sorted S(t) generator, streams S(t) into the s points chunk
+    Workspace local_workspace;                   // Temporary workspace, used if the caller does not provide one
     int s_idx = 0;                               // Index to traverse through the s points array
     long long int t = 0;                         // t point at which DBF needs to be calculated
     double dbf_i = 0.0;                          // DBFi(t, s) of i-th task for given (t, s) values
@@ -26,6 +29,12 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
     schedulability->taskset_schedulability = DEFAULT;
     schedulability->t_s_points = 0;
     schedulability->t_points = 0;
+    schedulability->peak_memory = 0;
+    schedulability->witness.t = 0;
+    schedulability->witness.s = 0;
+    schedulability->witness.demand = 0.0;
+    schedulability->kernel = KERNEL_GENERIC;
+    schedulability->cached_t_points = 0;
 
     // Check the first EDF schedulability condition: Max{U_HI, U_LO} < 1.0 for the given taskset
 
@@ -52,26 +61,39 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
         floor_t_upper_bound = (long long int)(floor(t_upper_bound));
         schedulability->interval_length = floor_t_upper_bound;
 
-        // Calculate number of jobs in floor_t_upper_bound for each task
-        for (int i = 0; i < num_tasks; i++) {
-            tasks[i].num_jobs = get_num_jobs(floor_t_upper_bound, tasks[i].deadline, tasks[i].period);
-            num_jobs_total += tasks[i].num_jobs;
-        }
+        // Calculate total number of jobs in floor_t_upper_bound
+        for (int i = 0; i < num_tasks; i++)
+            num_jobs_total += get_num_jobs(floor_t_upper_bound, tasks[i].deadline, tasks[i].period);
 
-        // Allocate memory for s points array (max s points = num_jobs_total + 1)
-        s_points = malloc((num_jobs_total + 1) * sizeof(long long int));
+        // Reserve memory for the s points chunk (max s points = num_jobs_total + 1, bounded by S_POINTS_CHUNK_SIZE) and the S(t) generator
+        if (workspace == NULL) {
+            init_workspace(&local_workspace);
+            workspace = &local_workspace;
+        }
+        max_s_points = (int)(min(num_jobs_total + 1, S_POINTS_CHUNK_SIZE));
+        schedulability->peak_memory = max_s_points * sizeof(long long int) + num_tasks * sizeof(SPointsCursor);
+        if (!reserve_workspace(workspace, max_s_points, num_tasks)) {
+            if (workspace == &local_workspace)
+                free_workspace(&local_workspace);
+            schedulability->taskset_schedulability = OUT_OF_MEMORY;
+            return schedulability;
+        }
+        s_points = workspace->s_points;
 
         // DBF analysis as proposed in [3] 
 
         // For all t values
         for (t = 1; t <= floor_t_upper_bound; t++) {
 
-            // Initialize all array elements
-            for (int i = 0; i < (num_jobs_total + 1); i++)
-                s_points[i] = 0;
+            // Abandon the test if another thread cancelled it (e.g. portfolio execution)
+            if (test_cancelled(workspace)) {
+                schedulability->taskset_schedulability = CANCELLED;
+                break;
+            }
 
-            // Get the s points (i.e. S(t)) that we need to consider for DBFi(t, s) analysis
-            num_s_points = get_s_points(tasks, num_tasks, s_points, t);
+            // Get the first chunk of s points (i.e. S(t)) that we need to consider for DBFi(t, s) analysis
+            init_s_points_iterator(&s_points_iterator, workspace->s_points_heap, tasks, num_tasks, t);
+            num_s_points = get_s_points(&s_points_iterator, s_points, max_s_points);
 
             // Initialize s_points index to 0 for each t
             s_idx = 0;
@@ -92,7 +114,7 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
                     if (tasks[i].criticality == LO) {
 
                         // Calculate DBFi as per eqn 13b [3]
-                        dbf_i = get_num_jobs(t, tasks[i].deadline, tasks[i].period) * tasks[i].wcet[HI] + min((int)(floor(s_points[s_idx] / (1.0 * tasks[i].period))) + 1, get_num_jobs(t, tasks[i].deadline, tasks[i].period)) * (tasks[i].wcet[LO] - tasks[i].wcet[HI]);
+                        dbf_i = get_num_jobs(t, tasks[i].deadline, tasks[i].period) * tasks[i].wcet[HI] + min(s_points[s_idx] / tasks[i].period + 1, get_num_jobs(t, tasks[i].deadline, tasks[i].period)) * (tasks[i].wcet[LO] - tasks[i].wcet[HI]);
                     }
 
                     // If the given task is a HI criticality task
@@ -117,6 +139,9 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
                         schedulability->failed_case1 = 1;
                     if (t <= (0.25 * floor_t_upper_bound))
                         schedulability->failed_case2 = 1;
+                    schedulability->witness.t = t;
+                    schedulability->witness.s = s_points[s_idx];
+                    schedulability->witness.demand = processor_demand;
                     schedulability->taskset_schedulability = NOT_SCHEDULABLE;
                     break;
                 }
@@ -126,6 +151,12 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
                     break;
 
                 s_idx++;
+
+                // Once the current chunk is consumed, stream in the next chunk of S(t)
+                if (s_idx == num_s_points) {
+                    num_s_points = get_s_points(&s_points_iterator, s_points, max_s_points);
+                    s_idx = 0;
+                }
             }
             
             schedulability->t_points++;
@@ -141,8 +172,9 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
         if (schedulability->taskset_schedulability == DEFAULT)
             schedulability->taskset_schedulability = SCHEDULABLE;
 
-        // Free all the dynamically allocated memory
-        free(s_points);
+        // Free the temporary workspace (a caller-provided workspace is kept warm for the next taskset)
+        if (workspace == &local_workspace)
+            free_workspace(&local_workspace);
 
         // Return schedulability
         return schedulability;
@@ -155,6 +187,7 @@ Schedulability* schedulability_test (Tasks *tasks, int num_tasks, Schedulability
         schedulability->failed_case2 = 1;
         schedulability->t_s_points = 0;
         schedulability->t_points = 0;
+        schedulability->peak_memory = 0;
         schedulability->taskset_schedulability = NOT_SCHEDULABLE;
         return schedulability;
     }
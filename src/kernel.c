@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../inc/auxiliary.h"
+#include "../inc/kernel.h"
+
+// Specialized processor demand kernels
+//
+// The generic evaluation loops over all tasks at every (t, s) point, computing psi_i(t) and branching on the criticality of each task.
+// For a given t, however:
+//    LO criticality: DBFi(t, s) = psi_i(t) * Ci(HI) + min(s / Ti + 1, psi_i(t)) * (Ci(LO) - Ci(HI))
+//    HI criticality: DBFi(t, s) = psi_i(t) * Ci(LO) + psi_i(t - s) * (Ci(HI) - Ci(LO))
+// so the psi_i(t) terms (the base demand) are summed once per t, and only the second terms are evaluated per s, in branch-free loops over
+// the LO and HI criticality tasks whose two wcets differ. Without HI criticality tasks, S(t) = {t}, min(t / Ti + 1, psi_i(t)) = psi_i(t)
+// and the demand reduces to the base demand sum of psi_i(t) * Ci(LO) (classical QPA).
+// The kernels sum the terms in a different order than the generic loop, so the demands may differ in the last bits.
+
+// Number of jobs with arrival and deadline within [0, interval] (psi_i)
+
+static inline long long int get_kernel_num_jobs (long long int interval, long long int deadline, long long int period) {
+
+    return (interval < deadline) ? 0 : (interval - deadline) / period + 1;
+}
+
+// KERNEL_GENERIC: loop over all tasks
+
+static double get_demand_generic (const DemandKernel *kernel, long long int s) {
+
+    return get_processor_demand(kernel->tasks, kernel->num_tasks, kernel->t, s);
+}
+
+// KERNEL_PARTITIONED: base demand + LO and HI criticality task loops
+
+static double get_demand_partitioned (const DemandKernel *kernel, long long int s) {
+
+    double demand = kernel->base_demand;    // Processor demand at (t, s)
+    long long int num_jobs = 0;             // min(s / Ti + 1, psi_i(t)) for LO criticality tasks, psi_i(t - s) for HI criticality tasks
+
+    for (int j = 0; j < kernel->num_lo; j++) {
+        num_jobs = s / kernel->lo_period[j] + 1;
+        demand += ((num_jobs < kernel->lo_num_jobs[j]) ? num_jobs : kernel->lo_num_jobs[j]) * kernel->lo_delta[j];
+    }
+
+    for (int j = 0; j < kernel->num_hi; j++)
+        demand += get_kernel_num_jobs(kernel->t - s, kernel->hi_deadline[j], kernel->hi_period[j]) * kernel->hi_delta[j];
+
+    return demand;
+}
+
+// KERNEL_ALL_LO: the demand at s = t (the only s point) is the base demand
+
+static double get_demand_all_lo (const DemandKernel *kernel, long long int s) {
+
+    (void)s;
+    return kernel->base_demand;
+}
+
+// KERNEL_ALL_HI: base demand + HI criticality task loop
+
+static double get_demand_all_hi (const DemandKernel *kernel, long long int s) {
+
+    double demand = kernel->base_demand;    // Processor demand at (t, s)
+
+    for (int j = 0; j < kernel->num_hi; j++)
+        demand += get_kernel_num_jobs(kernel->t - s, kernel->hi_deadline[j], kernel->hi_period[j]) * kernel->hi_delta[j];
+
+    return demand;
+}
+
+// Initialize an empty kernel
+
+void init_demand_kernel (DemandKernel *kernel) {
+
+    kernel->variant = KERNEL_GENERIC;
+    kernel->get_demand = get_demand_generic;
+    kernel->tasks = NULL;
+    kernel->num_tasks = 0;
+    kernel->t = 0;
+    kernel->base_demand = 0.0;
+    kernel->num_lo = 0;
+    kernel->num_hi = 0;
+    kernel->lo_period = NULL;
+    kernel->lo_deadline = NULL;
+    kernel->lo_num_jobs = NULL;
+    kernel->lo_delta = NULL;
+    kernel->hi_period = NULL;
+    kernel->hi_deadline = NULL;
+    kernel->hi_delta = NULL;
+    kernel->capacity = 0;
+}
+
+// Grow the task arrays of the kernel (if needed) to hold num_tasks tasks. Return 1 on success, 0 if out of memory (the kernel is left empty)
+
+int reserve_demand_kernel (DemandKernel *kernel, int num_tasks) {
+
+    if (kernel->capacity >= num_tasks)
+        return 1;
+
+    free_demand_kernel(kernel);
+    kernel->lo_period = malloc(num_tasks * sizeof(long long int));
+    kernel->lo_deadline = malloc(num_tasks * sizeof(long long int));
+    kernel->lo_num_jobs = malloc(num_tasks * sizeof(long long int));
+    kernel->lo_delta = malloc(num_tasks * sizeof(double));
+    kernel->hi_period = malloc(num_tasks * sizeof(long long int));
+    kernel->hi_deadline = malloc(num_tasks * sizeof(long long int));
+    kernel->hi_delta = malloc(num_tasks * sizeof(double));
+
+    if (kernel->lo_period == NULL || kernel->lo_deadline == NULL || kernel->lo_num_jobs == NULL || kernel->lo_delta == NULL ||
+        kernel->hi_period == NULL || kernel->hi_deadline == NULL || kernel->hi_delta == NULL) {
+        free_demand_kernel(kernel);
+        return 0;
+    }
+
+    kernel->capacity = num_tasks;
+    return 1;
+}
+
+// Set the kernel up for the given taskset. A variant that does not apply to the taskset falls back on KERNEL_GENERIC. Return the variant in use
+
+int setup_demand_kernel (DemandKernel *kernel, const Tasks *tasks, int num_tasks, int variant) {
+
+    int num_hi_tasks = 0;    // Number of HI criticality tasks (including those with Ci(HI) = Ci(LO))
+
+    // Precondition check (the task arrays are grown by reserve_demand_kernel)
+    assert(variant >= KERNEL_AUTO && variant < NUM_KERNELS && kernel->capacity >= num_tasks);
+
+    kernel->tasks = tasks;
+    kernel->num_tasks = num_tasks;
+
+    // Split the tasks whose DBF depends on s by criticality
+    kernel->num_lo = 0;
+    kernel->num_hi = 0;
+    for (int i = 0; i < num_tasks; i++) {
+        if (tasks[i].criticality == HI)
+            num_hi_tasks++;
+        if (tasks[i].wcet[LO] == tasks[i].wcet[HI])
+            continue;
+        if (tasks[i].criticality == LO) {
+            kernel->lo_period[kernel->num_lo] = tasks[i].period;
+            kernel->lo_deadline[kernel->num_lo] = tasks[i].deadline;
+            kernel->lo_delta[kernel->num_lo] = tasks[i].wcet[LO] - tasks[i].wcet[HI];
+            kernel->num_lo++;
+        }
+        else {
+            kernel->hi_period[kernel->num_hi] = tasks[i].period;
+            kernel->hi_deadline[kernel->num_hi] = tasks[i].deadline;
+            kernel->hi_delta[kernel->num_hi] = tasks[i].wcet[HI] - tasks[i].wcet[LO];
+            kernel->num_hi++;
+        }
+    }
+
+    // Select the kernel at dispatch time: dedicated paths for single-criticality tasksets, else the partitioned kernel
+    if (variant == KERNEL_AUTO) {
+        if (num_hi_tasks == 0)
+            variant = KERNEL_ALL_LO;
+        else if (kernel->num_lo == 0)
+            variant = KERNEL_ALL_HI;
+        else
+            variant = KERNEL_PARTITIONED;
+    }
+
+    // Fall back on the generic kernel if the requested one does not apply
+    if ((variant == KERNEL_ALL_LO && num_hi_tasks > 0) || (variant == KERNEL_ALL_HI && kernel->num_lo > 0))
+        variant = KERNEL_GENERIC;
+
+    kernel->variant = variant;
+    switch (variant) {
+
+        case KERNEL_PARTITIONED:
+            kernel->get_demand = get_demand_partitioned;
+            break;
+
+        case KERNEL_ALL_LO:
+            kernel->get_demand = get_demand_all_lo;
+            break;
+
+        case KERNEL_ALL_HI:
+            kernel->get_demand = get_demand_all_hi;
+            break;
+
+        default:
+            kernel->get_demand = get_demand_generic;
+            break;
+    }
+
+    return variant;
+}
+
+// Set the current t of the kernel (computes the s-independent part of the demand)
+
+void set_demand_kernel_t (DemandKernel *kernel, long long int t) {
+
+    const Tasks *tasks = kernel->tasks;
+    long long int num_jobs = 0;    // psi_i(t)
+
+    kernel->t = t;
+    if (kernel->variant == KERNEL_GENERIC)
+        return;
+
+    // Base demand: psi_i(t) * Ci(LO) without HI criticality tasks (s = t), else the psi_i(t) terms of the DBFs
+    kernel->base_demand = 0.0;
+    for (int i = 0; i < kernel->num_tasks; i++) {
+        num_jobs = get_kernel_num_jobs(t, tasks[i].deadline, tasks[i].period);
+        if (kernel->variant == KERNEL_ALL_LO || tasks[i].criticality == HI)
+            kernel->base_demand += num_jobs * tasks[i].wcet[LO];
+        else
+            kernel->base_demand += num_jobs * tasks[i].wcet[HI];
+    }
+
+    // psi_i(t) of the LO criticality tasks, which bounds their s-dependent term
+    for (int j = 0; j < kernel->num_lo; j++)
+        kernel->lo_num_jobs[j] = get_kernel_num_jobs(t, kernel->lo_deadline[j], kernel->lo_period[j]);
+}
+
+// Release the memory held by the kernel
+
+void free_demand_kernel (DemandKernel *kernel) {
+
+    free(kernel->lo_period);
+    free(kernel->lo_deadline);
+    free(kernel->lo_num_jobs);
+    free(kernel->lo_delta);
+    free(kernel->hi_period);
+    free(kernel->hi_deadline);
+    free(kernel->hi_delta);
+    init_demand_kernel(kernel);
+}
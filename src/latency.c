@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <assert.h>
+#include "../inc/latency.h"
+
+// CPU time consumed by the calling thread, in nanoseconds
+
+long long int get_cpu_time_ns (void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Monotonic wall-clock time, in nanoseconds (for runs spread over several threads, e.g. portfolio execution)
+
+long long int get_wall_time_ns (void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Get the histogram bucket index of the given value
+
+static int get_bucket_index (long long int value) {
+
+    int shift = 0;    // Number of low-order bits dropped to fit the value into a sub-bucket
+
+    // Values below HISTOGRAM_SUB_BUCKET_COUNT are recorded exactly
+    if (value < HISTOGRAM_SUB_BUCKET_COUNT)
+        return (int)value;
+
+    // Larger values keep their HISTOGRAM_SUB_BUCKET_BITS most significant bits
+    shift = (63 - __builtin_clzll((unsigned long long int)value)) - HISTOGRAM_SUB_BUCKET_BITS + 1;
+
+    return shift * (HISTOGRAM_SUB_BUCKET_COUNT / 2) + (int)(value >> shift);
+}
+
+// Get the highest value recorded in the given histogram bucket
+
+static long long int get_bucket_value (int idx) {
+
+    int shift = 0;
+
+    if (idx < HISTOGRAM_SUB_BUCKET_COUNT)
+        return idx;
+
+    shift = idx / (HISTOGRAM_SUB_BUCKET_COUNT / 2) - 1;
+
+    return ((long long int)(idx - shift * (HISTOGRAM_SUB_BUCKET_COUNT / 2) + 1) << shift) - 1;
+}
+
+// Reset the latency statistics
+
+void init_latency_stats (LatencyStats *latency_stats) {
+
+    for (int i = 0; i < HISTOGRAM_NUM_BUCKETS; i++)
+        latency_stats->histogram.counts[i] = 0;
+    latency_stats->histogram.total_count = 0;
+    latency_stats->histogram.max_value = 0;
+    latency_stats->num_slowest = 0;
+}
+
+// Record the latency of a test run on a single taskset, along with the test results
+
+void record_latency (LatencyStats *latency_stats, long long int latency, const Schedulability *schedulability) {
+
+    int idx = 0;    // Insertion index into the slowest tasksets
+
+    // Precondition check
+    assert(latency_stats != NULL && schedulability != NULL);
+
+    if (latency < 0)
+        latency = 0;
+
+    // Update the histogram
+    latency_stats->histogram.counts[get_bucket_index(latency)]++;
+    latency_stats->histogram.total_count++;
+    if (latency_stats->histogram.max_value < latency)
+        latency_stats->histogram.max_value = latency;
+
+    // Insert the taskset into the slowest tasksets (insertion into a short array sorted in decreasing latency order)
+    idx = latency_stats->num_slowest;
+    if (idx == SLOWEST_TASKSETS) {
+        if (latency <= latency_stats->slowest[SLOWEST_TASKSETS - 1].latency)
+            return;
+        idx--;
+    }
+    else
+        latency_stats->num_slowest++;
+
+    while (idx > 0 && latency_stats->slowest[idx - 1].latency < latency) {
+        latency_stats->slowest[idx] = latency_stats->slowest[idx - 1];
+        idx--;
+    }
+
+    latency_stats->slowest[idx].latency = latency;
+    latency_stats->slowest[idx].interval_length = schedulability->interval_length;
+    latency_stats->slowest[idx].t_points = schedulability->t_points;
+    latency_stats->slowest[idx].t_s_points = schedulability->t_s_points;
+}
+
+// Get the value at the given percentile (0.0 - 100.0) of the recorded latencies (ns), 0 if none was recorded
+
+long long int get_latency_percentile (const LatencyStats *latency_stats, double percentile) {
+
+    long long int rank = 0;     // Number of values at or below the requested percentile
+    long long int count = 0;    // Running number of values
+
+    if (latency_stats->histogram.total_count == 0)
+        return 0;
+
+    rank = (long long int)(percentile / 100.0 * latency_stats->histogram.total_count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    for (int i = 0; i < HISTOGRAM_NUM_BUCKETS; i++) {
+        count += latency_stats->histogram.counts[i];
+
+        // Report the highest value of the bucket, bounded by the exact maximum
+        if (count >= rank)
+            return (get_bucket_value(i) < latency_stats->histogram.max_value) ? get_bucket_value(i) : latency_stats->histogram.max_value;
+    }
+
+    return latency_stats->histogram.max_value;
+}
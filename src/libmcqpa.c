@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/libmcqpa.h"
+#include "../inc/schedtest.h"
+
+// =============================
+// ABSTRACT DATATYPE DEFINITIONS
+// =============================
+
+// Analysis context: scratch memory of the tests, reused across calls
+struct McqpaContext {
+    Workspace workspace;                 // s points chunk and S(t) generator heap
+    Witness *witnesses;                  // Candidate witnesses of the last witness-first analysis
+    int witness_capacity;                // Number of candidate witnesses the array can hold
+};
+
+// Immutable taskset
+struct McqpaTaskset {
+    int num_tasks;                       // Number of tasks
+    Tasks tasks[];                       // Task structure array
+};
+
+// Create an analysis context. Return NULL if out of memory
+
+McqpaContext* mcqpa_context_create (void) {
+
+    McqpaContext *context = malloc(sizeof(McqpaContext));
+
+    if (context != NULL) {
+        init_workspace(&context->workspace);
+        context->witnesses = NULL;
+        context->witness_capacity = 0;
+    }
+
+    return context;
+}
+
+// Release an analysis context
+
+void mcqpa_context_destroy (McqpaContext *context) {
+
+    if (context == NULL)
+        return;
+
+    free_workspace(&context->workspace);
+    free(context->witnesses);
+    free(context);
+}
+
+// Create an immutable taskset from num_tasks task parameters (the parameters are copied). Return NULL on invalid parameters / out of memory
+
+McqpaTaskset* mcqpa_taskset_create (const McqpaTaskParams *params, int num_tasks) {
+
+    McqpaTaskset *taskset;
+
+    if (params == NULL || num_tasks <= 0)
+        return NULL;
+
+    // Validate the task parameters (same constraints as the input file)
+    for (int i = 0; i < num_tasks; i++) {
+        if (params[i].period <= 0 || params[i].deadline <= 0 || (params[i].criticality != MCQPA_LO && params[i].criticality != MCQPA_HI) || !(params[i].wcet_lo >= 0.0) || !(params[i].wcet_hi >= 0.0))
+            return NULL;
+    }
+
+    taskset = malloc(sizeof(McqpaTaskset) + num_tasks * sizeof(Tasks));
+    if (taskset == NULL)
+        return NULL;
+
+    taskset->num_tasks = num_tasks;
+
+    // Fill the task structure array, as done by fetch_task_parameters
+    for (int i = 0; i < num_tasks; i++) {
+        taskset->tasks[i].task_no = i + 1;
+        taskset->tasks[i].period = params[i].period;
+        taskset->tasks[i].deadline = params[i].deadline;
+        taskset->tasks[i].criticality = params[i].criticality;
+        taskset->tasks[i].wcet[LO] = params[i].wcet_lo;
+        taskset->tasks[i].wcet[HI] = params[i].wcet_hi;
+        taskset->tasks[i].utilization[LO] = params[i].wcet_lo / params[i].period;
+        taskset->tasks[i].utilization[HI] = params[i].wcet_hi / params[i].period;
+    }
+
+    return taskset;
+}
+
+// Release a taskset
+
+void mcqpa_taskset_destroy (McqpaTaskset *taskset) {
+    free(taskset);
+}
+
+// Number of tasks in the taskset
+
+int mcqpa_taskset_size (const McqpaTaskset *taskset) {
+    return (taskset != NULL) ? taskset->num_tasks : 0;
+}
+
+// Analyse the taskset with the selected test, using the context's scratch memory. Return MCQPA_OK, MCQPA_EINVAL or MCQPA_ENOMEM
+
+int mcqpa_analyze (McqpaContext *context, const McqpaTaskset *taskset, McqpaTest test, McqpaResult *result) {
+
+    Schedulability schedulability;       // Result of the selected test
+
+    if (context == NULL || taskset == NULL || result == NULL)
+        return MCQPA_EINVAL;
+
+    // Run the selected test
+    switch (test) {
+        case MCQPA_TEST_ITERATIVE:
+            schedulability_test(taskset->tasks, taskset->num_tasks, &schedulability, &context->workspace);
+            break;
+        case MCQPA_TEST_MCQPA:
+            schedulability_test_mcqpa(taskset->tasks, taskset->num_tasks, &schedulability, &context->workspace);
+            break;
+        case MCQPA_TEST_APPROX:
+            schedulability_test_approx(taskset->tasks, taskset->num_tasks, &schedulability, &context->workspace);
+            break;
+        case MCQPA_TEST_MCQPA_SNAP:
+            schedulability_test_mcqpa_descent(taskset->tasks, taskset->num_tasks, DESCENT_SNAP, &schedulability, &context->workspace);
+            break;
+        default:
+            return MCQPA_EINVAL;
+    }
+
+    // The scratch memory could not be grown for this taskset (the context remains usable)
+    if (schedulability.taskset_schedulability == OUT_OF_MEMORY)
+        return MCQPA_ENOMEM;
+
+    // Copy the results
+    result->schedulable = (schedulability.taskset_schedulability == SCHEDULABLE);
+    result->interval_length = schedulability.interval_length;
+    result->t_points = schedulability.t_points;
+    result->t_s_points = schedulability.t_s_points;
+    result->peak_memory = schedulability.peak_memory;
+
+    return MCQPA_OK;
+}
+
+// Analyse the taskset with MC-QPA, checking the num_candidates candidate witnesses (e.g. returned for a similar taskset) first.
+// If witness is not NULL, it receives the violation witness of a NOT schedulable taskset (t = 0 if none). Return MCQPA_OK, MCQPA_EINVAL or MCQPA_ENOMEM
+
+int mcqpa_analyze_witnesses (McqpaContext *context, const McqpaTaskset *taskset, const McqpaWitness *candidates, int num_candidates, McqpaResult *result, McqpaWitness *witness) {
+
+    Schedulability schedulability;       // Result of the witness-first test
+    Witness *witnesses;                  // Grown candidate witness array
+
+    if (context == NULL || taskset == NULL || result == NULL || num_candidates < 0 || (candidates == NULL && num_candidates > 0))
+        return MCQPA_EINVAL;
+
+    // Grow the candidate witness array (if needed), so that warm calls perform no allocation
+    if (context->witness_capacity < num_candidates) {
+        witnesses = realloc(context->witnesses, num_candidates * sizeof(Witness));
+        if (witnesses == NULL)
+            return MCQPA_ENOMEM;
+        context->witnesses = witnesses;
+        context->witness_capacity = num_candidates;
+    }
+
+    // Copy the candidate witnesses
+    for (int w = 0; w < num_candidates; w++) {
+        context->witnesses[w].t = candidates[w].t;
+        context->witnesses[w].s = candidates[w].s;
+        context->witnesses[w].demand = candidates[w].demand;
+    }
+
+    schedulability_test_witness(taskset->tasks, taskset->num_tasks, context->witnesses, num_candidates, &schedulability, &context->workspace);
+    if (schedulability.taskset_schedulability == OUT_OF_MEMORY)
+        return MCQPA_ENOMEM;
+
+    // Copy the results
+    result->schedulable = (schedulability.taskset_schedulability == SCHEDULABLE);
+    result->interval_length = schedulability.interval_length;
+    result->t_points = schedulability.t_points;
+    result->t_s_points = schedulability.t_s_points;
+    result->peak_memory = schedulability.peak_memory;
+
+    if (witness != NULL) {
+        witness->t = schedulability.witness.t;
+        witness->s = schedulability.witness.s;
+        witness->demand = schedulability.witness.demand;
+    }
+
+    return MCQPA_OK;
+}
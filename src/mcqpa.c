@@ -6,7 +6,21 @@
 
 // MC-QPA (based on QPA [4]): A more efficient exact EDF schedulability test for 3-parameter sporadic task systems --> Listed as Algorithm 2 in the paper
 
-Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedulability *schedulability) {
+Schedulability* schedulability_test_mcqpa (const Tasks *tasks, int num_tasks, Schedulability *schedulability, Workspace *workspace) {
+    return schedulability_test_mcqpa_descent(tasks, num_tasks, MCQPA_DESCENT, schedulability, workspace);
+}
+
+// MC-QPA with the given descent strategy
+
+Schedulability* schedulability_test_mcqpa_descent (const Tasks *tasks, int num_tasks, int descent_strategy, Schedulability *schedulability, Workspace *workspace) {
+    return schedulability_test_mcqpa_kernel(tasks, num_tasks, descent_strategy, MCQPA_KERNEL, schedulability, workspace);
+}
+
+// MC-QPA with the given descent strategy and processor demand kernel
+// DESCENT_SNAP visits the step points of the maximum processor demand h only: h is constant between consecutive step points, so if h does
+// not exceed t at the largest step point t' <= t, it does not exceed any value in [t', t] either
+
+Schedulability* schedulability_test_mcqpa_kernel (const Tasks *tasks, int num_tasks, int descent_strategy, int kernel, Schedulability *schedulability, Workspace *workspace) {
 
     double lo_util_sum = 0.0;                    // Sum of LO criticality utilizations of all tasks U_LO
     double hi_util_sum = 0.0;                    // Sum of HI criticality utilizations of all tasks U_HI
@@ -14,12 +28,15 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
     double wcet_sum = 0.0;                       // Sum of wcets of all tasks at their own criticality level
     double t_upper_bound = 0.0;                  // [a.k.a. B] Upper bound for t that we need to consider when using DBFi(t, s) for a schedulability test
     long long int floor_t_upper_bound = 0;       // Floor of t upper bound
-    int num_jobs_total = 0;                      // Total number of jobs arriving and having deadlines within floor_t_upper_bound
-    long long int *s_points;                     // [a.k.a. S(t)] s values for which we need to calculate DBFi(t, s), s --> {t - kTi - Di} U {t}
-    int num_s_points = 0;                        // The number of s values in S(t)
+    long long int num_jobs_total = 0;            // Total number of jobs arriving and having deadlines within floor_t_upper_bound
+    long long int *s_points;                     // [a.k.a. S(t)] Chunk of s values for which we need to calculate DBFi(t, s), s --> {t - kTi - Di} U {t}
+    int max_s_points = 0;                        // s points chunk capacity
+    int num_s_points = 0;                        // The number of s values in the current chunk of S(t)
+    SPointsIterator s_points_iterator;           // Sorted S(t) generator, streams S(t) into the s points chunk
+    Workspace local_workspace;                   // Temporary workspace, used if the caller does not provide one
     int s_idx = 0;                               // Index to traverse through the s points array
     long long int t = 0;                         // t point at which DBF needs to be calculated
-    double dbf_i = 0.0;                          // DBFi(t, s) of i-th task for given (t, s) values
+    DemandKernel *demand_kernel = NULL;          // Processor demand kernel, selected once for the taskset
     double processor_demand = 0.0;               // Sum of DBFi(t, s) over all tasks for given (t, s) values
     double max_processor_demand = 0.0;           // Maximum sum of DBFi(t, s) of all tasks over all s values
 
@@ -27,6 +44,12 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
     schedulability->taskset_schedulability = DEFAULT;
     schedulability->t_s_points = 0;
     schedulability->t_points = 0;
+    schedulability->peak_memory = 0;
+    schedulability->witness.t = 0;
+    schedulability->witness.s = 0;
+    schedulability->witness.demand = 0.0;
+    schedulability->kernel = KERNEL_GENERIC;
+    schedulability->cached_t_points = 0;
 
     // Check the first EDF schedulability condition: Max{U_HI, U_LO} < 1.0 for the given taskset
 
@@ -53,29 +76,54 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
         floor_t_upper_bound = (long long int)(floor(t_upper_bound));
         schedulability->interval_length = floor_t_upper_bound;
 
-        // Calculate number of jobs in floor_t_upper_bound for each task
-        for (int i = 0; i < num_tasks; i++) {
-            tasks[i].num_jobs = get_num_jobs(floor_t_upper_bound, tasks[i].deadline, tasks[i].period);
-            num_jobs_total += tasks[i].num_jobs;
+        // Calculate total number of jobs in floor_t_upper_bound
+        for (int i = 0; i < num_tasks; i++)
+            num_jobs_total += get_num_jobs(floor_t_upper_bound, tasks[i].deadline, tasks[i].period);
+
+        // Reserve memory for the s points chunk (max s points = num_jobs_total + 1, bounded by S_POINTS_CHUNK_SIZE) and the S(t) generator
+        if (workspace == NULL) {
+            init_workspace(&local_workspace);
+            workspace = &local_workspace;
+        }
+        max_s_points = (int)(min(num_jobs_total + 1, S_POINTS_CHUNK_SIZE));
+        schedulability->peak_memory = max_s_points * sizeof(long long int) + num_tasks * sizeof(SPointsCursor);
+        if (!reserve_workspace(workspace, max_s_points, num_tasks)) {
+            if (workspace == &local_workspace)
+                free_workspace(&local_workspace);
+            schedulability->taskset_schedulability = OUT_OF_MEMORY;
+            return schedulability;
         }
+        s_points = workspace->s_points;
 
-        // Allocate memory for s points array (max s points = num_jobs_total + 1)
-        s_points = malloc((num_jobs_total + 1) * sizeof(long long int));
+        // Select the processor demand kernel (specialized for the criticality mix and number of tasks, or generic)
+        demand_kernel = &workspace->kernel;
+        schedulability->kernel = setup_demand_kernel(demand_kernel, tasks, num_tasks, kernel);
 
         // DBF analysis as proposed in [3] using QPA optimization [4]
 
         // Initialize t to its upper bound value
         t = floor_t_upper_bound;
+        if (descent_strategy == DESCENT_SNAP)
+            t = get_step_point(tasks, num_tasks, workspace->s_points_heap, t);
 
         // While t > 0
         while (t > 0) {
 
-            // Initialize all array elements
-            for (int i = 0; i < (num_jobs_total + 1); i++)
-                s_points[i] = 0;
+            // Abandon the test if another thread cancelled it (e.g. portfolio execution)
+            if (test_cancelled(workspace)) {
+                schedulability->taskset_schedulability = CANCELLED;
+                break;
+            }
+
+            // Get the first chunk of s points (i.e. S(t)) that we need to consider for DBFi(t, s) analysis, from the job lattice if it covers t
+            if (workspace->lattice != NULL && init_s_points_iterator_cached(&s_points_iterator, workspace->lattice, t))
+                schedulability->cached_t_points++;
+            else
+                init_s_points_iterator(&s_points_iterator, workspace->s_points_heap, tasks, num_tasks, t);
+            num_s_points = get_s_points(&s_points_iterator, s_points, max_s_points);
 
-            // Get the s points (i.e. S(t)) that we need to consider for DBFi(t, s) analysis
-            num_s_points = get_s_points(tasks, num_tasks, s_points, t);
+            // Compute the part of the processor demand that does not depend on s
+            set_demand_kernel_t(demand_kernel, t);
 
             // Initialize s_points and max_processor_demand index to 0 for each t
             s_idx = 0;
@@ -84,32 +132,8 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
             // Traverse through the S(t) array
             while (s_idx < num_s_points) {
 
-                // For a given (t, s) value initialize processor_demand
-                processor_demand = 0.0;
-
-                // For all tasks
-                for (int i = 0; i < num_tasks; i++) {
-
-                    // For a given task initialize dbf_i
-                    dbf_i = 0.0;
-
-                    // If the given task is a LO criticality task
-                    if (tasks[i].criticality == LO) {
-
-                        // Calculate DBFi as per eqn 1
-                        dbf_i = get_num_jobs(t, tasks[i].deadline, tasks[i].period) * tasks[i].wcet[HI] + min((int)(floor(s_points[s_idx] / (1.0 * tasks[i].period))) + 1, get_num_jobs(t, tasks[i].deadline, tasks[i].period)) * (tasks[i].wcet[LO] - tasks[i].wcet[HI]);
-                    }
-
-                    // If the given task is a HI criticality task
-                    else {
-
-                        // Calculate DBFi as per eqn 2
-                        dbf_i = get_num_jobs(t, tasks[i].deadline, tasks[i].period) * tasks[i].wcet[LO] + get_num_jobs(t - s_points[s_idx], tasks[i].deadline, tasks[i].period) * (tasks[i].wcet[HI] - tasks[i].wcet[LO]);
-                    }
-
-                    // Update summation DBFi(t, s)
-                    processor_demand = processor_demand + dbf_i;
-                }
+                // Calculate summation DBFi(t, s) over all tasks as per eqn 1 (LO criticality tasks) and eqn 2 (HI criticality tasks)
+                processor_demand = demand_kernel->get_demand(demand_kernel, s_points[s_idx]);
 
                 schedulability->t_s_points++;
 
@@ -122,6 +146,9 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
                         schedulability->failed_case1 = 1;
                     if (t <= (0.25 * floor_t_upper_bound))
                         schedulability->failed_case2 = 1;
+                    schedulability->witness.t = t;
+                    schedulability->witness.s = s_points[s_idx];
+                    schedulability->witness.demand = processor_demand;
                     schedulability->taskset_schedulability = NOT_SCHEDULABLE;
                     break;
                 }
@@ -135,6 +162,12 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
                     break;
 
                 s_idx++;
+
+                // Once the current chunk is consumed, stream in the next chunk of S(t)
+                if (s_idx == num_s_points) {
+                    num_s_points = get_s_points(&s_points_iterator, s_points, max_s_points);
+                    s_idx = 0;
+                }
             }
 
             schedulability->t_points++;
@@ -153,6 +186,10 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
             // Update the t value to the t - 1
             else
                 t = t - 1;
+
+            // Snap the t value down to the nearest step point of the maximum processor demand
+            if (descent_strategy == DESCENT_SNAP && t > 0)
+                t = get_step_point(tasks, num_tasks, workspace->s_points_heap, t);
         }
 
         // If the condition was satisfied at all t, s and retval still holds DEFAULT value 
@@ -160,8 +197,9 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
         if (schedulability->taskset_schedulability == DEFAULT)
             schedulability->taskset_schedulability = SCHEDULABLE;
 
-        // Free all the dynamically allocated memory
-        free(s_points);
+        // Free the temporary workspace (a caller-provided workspace is kept warm for the next taskset)
+        if (workspace == &local_workspace)
+            free_workspace(&local_workspace);
 
         // Return schedulability status
         return schedulability;
@@ -174,6 +212,7 @@ Schedulability* schedulability_test_mcqpa (Tasks *tasks, int num_tasks, Schedula
         schedulability->failed_case2 = 1;
         schedulability->t_s_points = 0;
         schedulability->t_points = 0;
+        schedulability->peak_memory = 0;
         schedulability->taskset_schedulability = NOT_SCHEDULABLE;
         return schedulability;
     }
@@ -0,0 +1,341 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <assert.h>
+#include "../inc/auxiliary.h"
+#include "../inc/schedtest.h"
+#include "../inc/generator.h"
+#include "../inc/latency.h"
+#include "../inc/partition.h"
+
+// Partitioned multiprocessor allocation
+//
+// Tasks are placed one at a time, in decreasing order of Ui(HI), Ui(LO) or density, on the first core (first fit), the most loaded core
+// (best fit) or the least loaded core (worst fit) on which the core's taskset stays schedulable. Each core keeps its utilizations, density
+// and the violation witnesses of the placements it rejected, so that most tentative placements are decided without the exact test:
+//    1. Max{U_HI, U_LO} >= 1.0 with the task                                           --> rejected (necessary condition of the exact test).
+//    2. Processor demand of the core's tasks + DBF of the task > t at a core witness   --> rejected (the demand only grows as tasks are added).
+//    3. Sum of max{Ci(LO), Ci(HI)} / min{Di, Ti} <= 1.0 with the task                  --> accepted (DBFi(t, s) <= that density * t for any s).
+//    4. Otherwise                                                                      --> MC-QPA on the core's tasks and the task (oracle call);
+//                                                                                          a rejection adds its witness to the core.
+
+// Density of a task: max{Ci(LO), Ci(HI)} / min{Di, Ti}
+
+static double get_task_density (const Tasks *task) {
+
+    return max(task->wcet[LO], task->wcet[HI]) / min(task->deadline, task->period);
+}
+
+// Load of a core: max{U_LO, U_HI}
+
+static double get_core_load (const Core *core) {
+
+    return max(core->utilization[LO], core->utilization[HI]);
+}
+
+// Sort the first num_indices indices by decreasing key (insertion sort: stable, and the arrays are short)
+
+static void sort_by_decreasing_key (int *indices, int num_indices, const double *keys) {
+
+    int idx = 0;
+
+    for (int i = 1; i < num_indices; i++) {
+        idx = indices[i];
+        int j = i - 1;
+        while (j >= 0 && keys[indices[j]] < keys[idx]) {
+            indices[j + 1] = indices[j];
+            j--;
+        }
+        indices[j + 1] = idx;
+    }
+}
+
+// Return 1 if the task can be placed on the core (the core's tasks and the task are SCHEDULABLE), else 0
+
+static int check_placement (Partition *partition, Core *core, const Tasks *task) {
+
+    Schedulability schedulability;    // Result of the exact test
+    Witness *witness = NULL;          // Witness added to the core
+
+    partition->placement_attempts++;
+
+    // 1. Necessary condition: Max{U_HI, U_LO} < 1.0 (summed in the same order as the exact test)
+    if (max(core->utilization[LO] + task->utilization[LO], core->utilization[HI] + task->utilization[HI]) >= 1.0) {
+        partition->utilization_rejections++;
+        return 0;
+    }
+
+    // 2. Violation witnesses of the placements the core rejected earlier
+    for (int w = 0; w < core->num_witnesses; w++) {
+        if (core->witnesses[w].demand + get_processor_demand(task, 1, core->witnesses[w].t, core->witnesses[w].s) > core->witnesses[w].t) {
+            partition->witness_rejections++;
+            return 0;
+        }
+    }
+
+    // 3. Sufficient condition: density bound
+    if (core->density + get_task_density(task) <= 1.0) {
+        partition->density_acceptances++;
+        return 1;
+    }
+
+    // 4. Exact test on the core's tasks and the candidate task (stored after the core's tasks)
+    partition->oracle_calls++;
+    core->tasks[core->num_tasks] = *task;
+    schedulability_test_mcqpa(core->tasks, core->num_tasks + 1, &schedulability, &partition->workspace);
+    if (schedulability.taskset_schedulability == SCHEDULABLE)
+        return 1;
+
+    // Keep the witness, along with the processor demand of the core's tasks at that point
+    if (PARTITION_CORE_WITNESSES > 0 && schedulability.witness.t > 0) {
+        witness = &core->witnesses[core->next_witness];
+        *witness = schedulability.witness;
+        witness->demand = get_processor_demand(core->tasks, core->num_tasks, witness->t, witness->s);
+        core->next_witness = (core->next_witness + 1) % PARTITION_CORE_WITNESSES;
+        if (core->num_witnesses < PARTITION_CORE_WITNESSES)
+            core->num_witnesses++;
+    }
+
+    return 0;
+}
+
+// Place the task on the core and update the core's analysis state
+
+static void place_task (Core *core, const Tasks *task) {
+
+    core->tasks[core->num_tasks] = *task;
+    core->num_tasks++;
+    core->utilization[LO] += task->utilization[LO];
+    core->utilization[HI] += task->utilization[HI];
+    core->density += get_task_density(task);
+
+    // The witnesses keep the processor demand of the core's tasks
+    for (int w = 0; w < core->num_witnesses; w++)
+        core->witnesses[w].demand += get_processor_demand(task, 1, core->witnesses[w].t, core->witnesses[w].s);
+}
+
+// Initialize the partitioning state for tasksets of up to max_tasks tasks on up to max_cores cores
+
+void init_partition (Partition *partition, int max_tasks, int max_cores) {
+
+    // Precondition check
+    assert(partition != NULL && max_tasks > 0 && max_cores > 0);
+
+    partition->max_cores = max_cores;
+    partition->num_cores = 0;
+    partition->max_tasks = max_tasks;
+    partition->cores = malloc(max_cores * sizeof(Core));
+    partition->assignment = malloc(max_tasks * sizeof(int));
+    partition->task_order = malloc(max_tasks * sizeof(int));
+    partition->keys = malloc(max_tasks * sizeof(double));
+    partition->core_order = malloc(max_cores * sizeof(int));
+    assert(partition->cores != NULL && partition->assignment != NULL && partition->task_order != NULL && partition->keys != NULL && partition->core_order != NULL);
+
+    // Core task arrays are allocated when the core is first used
+    for (int c = 0; c < max_cores; c++)
+        partition->cores[c].tasks = NULL;
+
+    init_workspace(&partition->workspace);
+}
+
+// Partition the taskset with the given heuristic and task order (decreasing). Return the number of cores used, 0 if some task cannot be placed
+
+int partition_taskset (Partition *partition, const Tasks *tasks, int num_tasks, int heuristic, int order) {
+
+    double core_loads[partition->max_cores];    // Load of each core, sort key of the probing order
+    const Tasks *task = NULL;                   // Task being placed
+    Core *core = NULL;                          // Core being probed
+    int placed = 0;                             // Set to 1 once the task is placed
+
+    // Precondition check
+    assert(tasks != NULL && num_tasks > 0 && num_tasks <= partition->max_tasks);
+    assert(heuristic >= 0 && heuristic < NUM_PARTITION_HEURISTICS && order >= 0 && order < NUM_PARTITION_ORDERS);
+
+    // Reset the cores and the statistics
+    partition->num_cores = 0;
+    partition->placement_attempts = 0;
+    partition->utilization_rejections = 0;
+    partition->witness_rejections = 0;
+    partition->density_acceptances = 0;
+    partition->oracle_calls = 0;
+
+    // Order the tasks
+    for (int i = 0; i < num_tasks; i++) {
+        partition->assignment[i] = -1;
+        partition->task_order[i] = i;
+        if (order == PARTITION_ORDER_U_HI)
+            partition->keys[i] = tasks[i].utilization[HI];
+        else if (order == PARTITION_ORDER_U_LO)
+            partition->keys[i] = tasks[i].utilization[LO];
+        else
+            partition->keys[i] = get_task_density(&tasks[i]);
+    }
+    sort_by_decreasing_key(partition->task_order, num_tasks, partition->keys);
+
+    // Place the tasks one at a time
+    for (int k = 0; k < num_tasks; k++) {
+
+        task = &tasks[partition->task_order[k]];
+        placed = 0;
+
+        // Probing order of the cores in use: index (first fit), decreasing load (best fit) or increasing load (worst fit).
+        // The task goes to the first core it fits on, i.e. the core selected by the heuristic among the feasible ones
+        for (int c = 0; c < partition->num_cores; c++) {
+            partition->core_order[c] = c;
+            core_loads[c] = (heuristic == PARTITION_WORST_FIT) ? -get_core_load(&partition->cores[c]) : get_core_load(&partition->cores[c]);
+        }
+        if (heuristic != PARTITION_FIRST_FIT)
+            sort_by_decreasing_key(partition->core_order, partition->num_cores, core_loads);
+
+        for (int c = 0; c < partition->num_cores && !placed; c++) {
+            core = &partition->cores[partition->core_order[c]];
+            if (check_placement(partition, core, task)) {
+                place_task(core, task);
+                partition->assignment[partition->task_order[k]] = partition->core_order[c];
+                placed = 1;
+            }
+        }
+
+        // Open a new core if the task fits on none of the cores in use
+        if (!placed && partition->num_cores < partition->max_cores) {
+            core = &partition->cores[partition->num_cores];
+            if (core->tasks == NULL)
+                core->tasks = malloc((partition->max_tasks + 1) * sizeof(Tasks));
+            assert(core->tasks != NULL);
+            core->num_tasks = 0;
+            core->utilization[LO] = 0.0;
+            core->utilization[HI] = 0.0;
+            core->density = 0.0;
+            core->num_witnesses = 0;
+            core->next_witness = 0;
+            partition->num_cores++;
+
+            if (check_placement(partition, core, task)) {
+                place_task(core, task);
+                partition->assignment[partition->task_order[k]] = partition->num_cores - 1;
+                placed = 1;
+            }
+        }
+
+        // The task cannot be placed (no core left, or not schedulable on its own)
+        if (!placed)
+            return 0;
+    }
+
+    return partition->num_cores;
+}
+
+// Release the partitioning state
+
+void free_partition (Partition *partition) {
+
+    for (int c = 0; c < partition->max_cores; c++)
+        free(partition->cores[c].tasks);
+    free(partition->cores);
+    free(partition->assignment);
+    free(partition->task_order);
+    free(partition->keys);
+    free(partition->core_order);
+    free_workspace(&partition->workspace);
+}
+
+// Partitioning sweep (input method 'p'): cores needed, exact test calls and packing throughput of every heuristic and task order, as n and m grow.
+// Every taskset is partitionable on m cores, so the cores needed can be compared with m
+
+void run_partition_sweep (FILE *output_fptr) {
+
+    const int sweep_cores[PARTITION_SWEEP_NUM_CORES] = PARTITION_SWEEP_CORES;
+    const int sweep_tasks_per_core[PARTITION_SWEEP_NUM_SIZES] = PARTITION_SWEEP_TASKS_PER_CORE;
+    const char *heuristic_names[NUM_PARTITION_HEURISTICS] = {"First fit", "Best fit", "Worst fit"};
+    const char *order_names[NUM_PARTITION_ORDERS] = {"U_HI", "U_LO", "Density"};
+
+    Partition partition;                  // Partitioning state, reused across tasksets
+    Tasks **tasksets;                     // Tasksets of the sweep cell (shared by all heuristics and orders)
+    Schedulability schedulability;        // Result of the exact test on a generated block
+    int num_cores = 0;                    // Number of cores m the tasksets are generated for
+    int num_tasks = 0;                    // Number of tasks n
+    int cores_used = 0;                   // Number of cores used by the last partitioning
+    long long int sum_cores = 0;          // Total number of cores used by the successful partitionings
+    int num_failed = 0;                   // Number of tasksets that could not be partitioned
+    long long int attempts = 0;           // Total number of placement attempts
+    long long int utilization_rejections = 0;
+    long long int witness_rejections = 0;
+    long long int density_acceptances = 0;
+    long long int oracle_calls = 0;       // Total number of exact test calls
+    long long int partition_time = 0;     // CPU time (ns) taken by all partitionings of a heuristic and order
+
+    srand(time(0));
+
+    fprintf(output_fptr, "Cores (m),Tasks (n),Heuristic,Order,Av cores used,Failed tasksets,Placement attempts,Utilization rejections,Witness rejections,Density acceptances,Oracle calls,Partitioning time,Partitionings per second,Tasks placed per second\n");
+
+    for (int mi = 0; mi < PARTITION_SWEEP_NUM_CORES; mi++) {
+        for (int ni = 0; ni < PARTITION_SWEEP_NUM_SIZES; ni++) {
+
+            num_cores = sweep_cores[mi];
+            num_tasks = sweep_tasks_per_core[ni] * num_cores;
+
+            // Any number of cores may be used, so that the cores needed are measured
+            init_partition(&partition, num_tasks, num_tasks);
+
+            // Generate the tasksets: m blocks of n / m tasks with a total utilization of PARTITION_CORE_UTILIZATION each (the generator
+            // draws utilizations below 1.0 only). Blocks are redrawn until SCHEDULABLE, so that every taskset fits on m cores
+            tasksets = malloc(PARTITION_NUM_TASKSETS * sizeof(Tasks*));
+            for (int k = 0; k < PARTITION_NUM_TASKSETS; k++) {
+                tasksets[k] = malloc(num_tasks * sizeof(Tasks));
+                for (int c = 0; c < num_cores; c++) {
+                    do {
+                        task_parameter_generator(tasksets[k] + c * sweep_tasks_per_core[ni], sweep_tasks_per_core[ni], PARTITION_CORE_UTILIZATION, PARTITION_CRITICALITY_PROPORTION);
+                        schedulability_test_mcqpa(tasksets[k] + c * sweep_tasks_per_core[ni], sweep_tasks_per_core[ni], &schedulability, &partition.workspace);
+                    } while (schedulability.taskset_schedulability != SCHEDULABLE);
+                }
+                for (int i = 0; i < num_tasks; i++)
+                    tasksets[k][i].task_no = i + 1;
+            }
+
+            printf("\n Cores: %d\t Tasks: %d\n", num_cores, num_tasks);
+
+            for (int heuristic = 0; heuristic < NUM_PARTITION_HEURISTICS; heuristic++) {
+                for (int order = 0; order < NUM_PARTITION_ORDERS; order++) {
+
+                    sum_cores = 0;
+                    num_failed = 0;
+                    attempts = 0;
+                    utilization_rejections = 0;
+                    witness_rejections = 0;
+                    density_acceptances = 0;
+                    oracle_calls = 0;
+                    partition_time = get_cpu_time_ns();
+
+                    for (int k = 0; k < PARTITION_NUM_TASKSETS; k++) {
+                        cores_used = partition_taskset(&partition, tasksets[k], num_tasks, heuristic, order);
+                        if (cores_used > 0)
+                            sum_cores += cores_used;
+                        else
+                            num_failed++;
+                        attempts += partition.placement_attempts;
+                        utilization_rejections += partition.utilization_rejections;
+                        witness_rejections += partition.witness_rejections;
+                        density_acceptances += partition.density_acceptances;
+                        oracle_calls += partition.oracle_calls;
+                    }
+
+                    partition_time = get_cpu_time_ns() - partition_time;
+
+                    printf(" %s (%s)\t Av cores used: %lf\t Failed: %d\t Placement attempts: %lld\t Utilization rejections: %lld\t Witness rejections: %lld\t Density acceptances: %lld\t Oracle calls: %lld\t Partitioning time: %lf\n",
+                           heuristic_names[heuristic], order_names[order], (num_failed < PARTITION_NUM_TASKSETS) ? sum_cores / (double)(PARTITION_NUM_TASKSETS - num_failed) : 0.0, num_failed,
+                           attempts, utilization_rejections, witness_rejections, density_acceptances, oracle_calls, partition_time / 1e9);
+                    fprintf(output_fptr, "%d,%d,%s,%s,%lf,%d,%lld,%lld,%lld,%lld,%lld,%lf,%lf,%lf\n", num_cores, num_tasks, heuristic_names[heuristic], order_names[order],
+                            (num_failed < PARTITION_NUM_TASKSETS) ? sum_cores / (double)(PARTITION_NUM_TASKSETS - num_failed) : 0.0, num_failed,
+                            attempts, utilization_rejections, witness_rejections, density_acceptances, oracle_calls, partition_time / 1e9,
+                            PARTITION_NUM_TASKSETS / (partition_time / 1e9), PARTITION_NUM_TASKSETS * (double)num_tasks / (partition_time / 1e9));
+                    fflush(output_fptr);
+                }
+            }
+
+            free_partition(&partition);
+            for (int k = 0; k < PARTITION_NUM_TASKSETS; k++)
+                free(tasksets[k]);
+            free(tasksets);
+        }
+    }
+}
@@ -0,0 +1,680 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <limits.h>
+#include <assert.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../inc/pipeline.h"
+#include "../inc/generator.h"
+#include "../inc/canonical.h"
+#include "../inc/latency.h"
+#include "../inc/verify.h"
+#include "../inc/witness.h"
+#include "../inc/sampling.h"
+#include "../inc/portfolio.h"
+
+// Staged analysis pipeline
+//
+// Generating (or reading) a taskset, canonicalizing it, computing its utilization and writing the results are cheap compared with the exact
+// tests, but done in sequence they still sit on the critical path of every taskset. The pipeline runs them on their own threads:
+//    generator / reader --> prefilter --> exact-test workers --> aggregator (calling thread, all statistics and output)
+// linked by bounded lock-free queues. A full queue blocks its producer (backpressure), so at most a few queues' worth of tasksets is in flight,
+// and every stage records how long it waited on its input (starved) and on its output (blocked): the stage with the highest utilization
+// is the bottleneck. The aggregator consumes the tasksets in generation order, so that sequential sampling (sampling.h) and the per-taskset
+// output of the input file are unchanged. The generator does not know when an adaptive cell has enough tasksets and runs ahead of the
+// aggregator: the tasksets generated beyond the needs of their cell are skipped by the workers (or dropped by the aggregator) and counted
+// as discarded.
+
+// ====================
+// BOUNDED QUEUE
+// ====================
+
+// Initialize an empty bounded queue with the given capacity (power of 2)
+
+void init_bounded_queue (BoundedQueue *queue, size_t capacity) {
+
+    // Precondition check
+    assert(queue != NULL && capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+    queue->slots = malloc(capacity * sizeof(QueueSlot));
+    assert(queue->slots != NULL);
+    for (size_t position = 0; position < capacity; position++)
+        atomic_init(&queue->slots[position].sequence, position);
+    queue->mask = capacity - 1;
+    atomic_init(&queue->enqueue_position, 0);
+    atomic_init(&queue->dequeue_position, 0);
+}
+
+// Append an item to the queue. Return 1 on success, 0 if the queue is full
+
+int try_push_item (BoundedQueue *queue, void *item) {
+
+    size_t position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+    QueueSlot *slot;                     // Slot at the enqueue position
+    size_t sequence = 0;                 // Sequence number of the slot
+    long long int difference = 0;        // 0 --> the slot is free for this position, < 0 --> the queue is full, > 0 --> another producer took it
+
+    while (1) {
+        slot = &queue->slots[position & queue->mask];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        difference = (long long int)sequence - (long long int)position;
+
+        // Claim the slot, or retry from the position another producer left
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+    }
+
+    // Fill the slot and publish it to the consumers
+    slot->item = item;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    return 1;
+}
+
+// Remove the oldest item from the queue. Return 1 on success, 0 if the queue is empty
+
+int try_pop_item (BoundedQueue *queue, void **item) {
+
+    size_t position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+    QueueSlot *slot;                     // Slot at the dequeue position
+    size_t sequence = 0;                 // Sequence number of the slot
+    long long int difference = 0;        // 0 --> the slot is filled for this position, < 0 --> the queue is empty, > 0 --> another consumer took it
+
+    while (1) {
+        slot = &queue->slots[position & queue->mask];
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        difference = (long long int)sequence - (long long int)(position + 1);
+
+        // Claim the slot, or retry from the position another consumer left
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_position, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            position = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+    }
+
+    // Empty the slot and hand it back to the producers (one lap later)
+    *item = slot->item;
+    atomic_store_explicit(&slot->sequence, position + queue->mask + 1, memory_order_release);
+
+    return 1;
+}
+
+// Release the memory held by the queue
+
+void free_bounded_queue (BoundedQueue *queue) {
+
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+// Back off while a queue is empty or full: yield the processor first, then sleep for exponentially longer times
+
+static void wait_for_queue (int *attempt) {
+
+    struct timespec sleep_time;          // Sleep duration
+
+    if (*attempt < PIPELINE_SPIN_LIMIT)
+        sched_yield();
+    else {
+        sleep_time.tv_sec = 0;
+        sleep_time.tv_nsec = 1000L << min(*attempt - PIPELINE_SPIN_LIMIT, 20);
+        if (sleep_time.tv_nsec > PIPELINE_MAX_SLEEP_NS)
+            sleep_time.tv_nsec = PIPELINE_MAX_SLEEP_NS;
+        nanosleep(&sleep_time, NULL);
+    }
+
+    (*attempt)++;
+}
+
+// Append an item to the queue, waiting while it is full (the wait is recorded as blocked time of the stage)
+
+static void push_blocking (BoundedQueue *queue, void *item, StageStats *stage_stats) {
+
+    int attempt = 0;                     // Number of failed attempts
+    long long int wait_start = 0;        // Wall-clock time of the first failed attempt
+
+    while (!try_push_item(queue, item)) {
+        if (attempt == 0)
+            wait_start = get_wall_time_ns();
+        wait_for_queue(&attempt);
+    }
+
+    if (attempt > 0)
+        stage_stats->blocked += get_wall_time_ns() - wait_start;
+}
+
+// Remove the oldest item from the queue, waiting while it is empty (the wait is recorded as starved time of the stage)
+
+static void* pop_blocking (BoundedQueue *queue, StageStats *stage_stats) {
+
+    void *item = NULL;                   // Item removed from the queue
+    int attempt = 0;                     // Number of failed attempts
+    long long int wait_start = 0;        // Wall-clock time of the first failed attempt
+
+    while (!try_pop_item(queue, &item)) {
+        if (attempt == 0)
+            wait_start = get_wall_time_ns();
+        wait_for_queue(&attempt);
+    }
+
+    if (attempt > 0)
+        stage_stats->starved += get_wall_time_ns() - wait_start;
+
+    return item;
+}
+
+// ====================
+// PIPELINE ITEMS
+// ====================
+
+// Allocate a taskset of the given size, to be filled by the generator / reader
+
+static PipelineItem* new_pipeline_item (long long int sequence, int cell, int num_tasks) {
+
+    PipelineItem *item = calloc(1, sizeof(PipelineItem));
+
+    assert(item != NULL && num_tasks >= 0);
+    item->sequence = sequence;
+    item->cell = cell;
+    item->num_tasks = num_tasks;
+    item->tasks = malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(Tasks));
+    item->canonical_tasks = malloc((num_tasks > 0 ? num_tasks : 1) * sizeof(Tasks));
+    item->num_canonical_tasks = -1;
+
+    return item;
+}
+
+// Allocate an end-of-stream marker
+
+static PipelineItem* new_end_marker (void) {
+
+    PipelineItem *item = calloc(1, sizeof(PipelineItem));
+
+    assert(item != NULL);
+    item->end = 1;
+
+    return item;
+}
+
+// Release a taskset handed over by next_pipeline_item
+
+void free_pipeline_item (PipelineItem *item) {
+
+    free(item->tasks);
+    free(item->canonical_tasks);
+    free(item);
+}
+
+// ====================
+// STAGES
+// ====================
+
+// Wait until the taskset of the given sequence fits in the reorder window of the aggregator (the wait is recorded as blocked time of the stage).
+// The prefilter sends some tasksets straight to the aggregator, and a worker may hold a slow taskset while the others go on, so the queues
+// alone do not bound how far the tasksets received by the aggregator run ahead of the next one to aggregate
+
+static void wait_for_reorder_window (Pipeline *pipeline, long long int sequence, StageStats *stage_stats) {
+
+    int attempt = 0;                     // Number of failed attempts
+    long long int wait_start = 0;        // Wall-clock time of the first failed attempt
+
+    while (sequence - atomic_load(&pipeline->next_sequence) >= PIPELINE_REORDER_SIZE) {
+        if (attempt == 0)
+            wait_start = get_wall_time_ns();
+        wait_for_queue(&attempt);
+    }
+
+    if (attempt > 0)
+        stage_stats->blocked += get_wall_time_ns() - wait_start;
+}
+
+// Generator / reader stage: generates the tasksets of every sweep cell (input method 't') or reads the input file (input method 'f')
+
+static void* generator_thread (void *arg) {
+
+    Pipeline *pipeline = arg;
+    StageStats *stage_stats = &pipeline->stage_stats[PIPELINE_GENERATE];
+    PipelineItem *item;                  // Taskset being generated
+    long long int sequence = 0;          // Sequence of the next taskset
+    int cell = 0;                        // Index of the current sweep cell
+    int num_tasks = 0;                   // Number of tasks of the taskset read
+    Sampling sampling;                   // Sampling policy of the sweep cells
+    int max_samples = 0;                 // Largest number of tasksets a sweep cell may need
+    BaseTasksetPool *base_pool;          // Base tasksets of the current criticality proportion (SWEEP_CRN)
+    const BaseTaskset *base_taskset;     // Base taskset of the current taskset (SWEEP_CRN)
+
+    stage_stats->start = get_wall_time_ns();
+
+    // Read the tasksets of the input file
+    if (pipeline->mode == 'f') {
+        for (int i = 0; i < pipeline->num_tasksets; i++) {
+            fscanf(pipeline->input_file, "%d\n", &num_tasks);
+            wait_for_reorder_window(pipeline, sequence, stage_stats);
+            item = new_pipeline_item(sequence++, 0, num_tasks);
+            fetch_task_parameters(pipeline->input_file, item->tasks, num_tasks);
+            stage_stats->num_items++;
+            push_blocking(&pipeline->generated, item, stage_stats);
+        }
+    }
+
+    // Generate the tasksets of every sweep cell, in the order of the sweep (same loops as the aggregator in driver.c)
+    else {
+        init_sampling(&sampling);
+        max_samples = get_max_samples(&sampling);
+
+        // For criticality proportions 0.25 to 0.75 (step: 0.25)
+        for (double criticality_proportion = 0.25; criticality_proportion <= 0.99; criticality_proportion += 0.25) {
+
+            srand(time(0));
+            pipeline->base_pools = realloc(pipeline->base_pools, (pipeline->num_base_pools + 1) * sizeof(BaseTasksetPool));
+            assert(pipeline->base_pools != NULL);
+            base_pool = &pipeline->base_pools[pipeline->num_base_pools++];
+            init_base_taskset_pool(base_pool, NUM_TASKS, criticality_proportion);
+
+            // For taskset utilizations 0.10 to 0.90 (step: 0.10)
+            for (double taskset_utilization = 0.10; taskset_utilization <= 0.95; taskset_utilization += 0.10) {
+
+                // Generate tasksets until the cell may need no more, or the aggregator has enough of them
+                for (int k = 0; k < max_samples && atomic_load(&pipeline->cells_done) <= cell; k++) {
+                    wait_for_reorder_window(pipeline, sequence, stage_stats);
+                    item = new_pipeline_item(sequence++, cell, NUM_TASKS);
+
+                    // Common random numbers: rescale the k-th base taskset of the criticality proportion and its canonical form
+                    if (SWEEP_CRN) {
+                        base_taskset = get_base_taskset(base_pool, k);
+                        scale_taskset(base_taskset->tasks, NUM_TASKS, taskset_utilization, item->tasks);
+                        item->num_canonical_tasks = base_taskset->num_canonical_tasks;
+                        scale_taskset(base_taskset->canonical_tasks, item->num_canonical_tasks, taskset_utilization, item->canonical_tasks);
+                        item->lattice = base_taskset->lattice;
+                        item->has_lattice = 1;
+                    }
+                    else
+                        task_parameter_generator(item->tasks, NUM_TASKS, taskset_utilization, criticality_proportion);
+
+                    stage_stats->num_items++;
+                    push_blocking(&pipeline->generated, item, stage_stats);
+                }
+
+                cell++;
+            }
+        }
+    }
+
+    // End of the stream
+    push_blocking(&pipeline->generated, new_end_marker(), stage_stats);
+    stage_stats->end = get_wall_time_ns();
+
+    return NULL;
+}
+
+// Prefilter stage: canonicalizes the tasksets and computes their utilization. Every test rejects a taskset with Max{U_HI, U_LO} >= 1.0
+// in O(n) at its first check, so such tasksets are decided here (by that check of MC-QPA) and go straight to the aggregator
+
+static void* prefilter_thread (void *arg) {
+
+    Pipeline *pipeline = arg;
+    StageStats *stage_stats = &pipeline->stage_stats[PIPELINE_PREFILTER];
+    PipelineItem *item;                  // Taskset being prefiltered
+    double lo_util_sum = 0.0;            // Sum of LO criticality utilizations of the canonical taskset U_LO
+    double hi_util_sum = 0.0;            // Sum of HI criticality utilizations of the canonical taskset U_HI
+
+    stage_stats->start = get_wall_time_ns();
+
+    while (!(item = pop_blocking(&pipeline->generated, stage_stats))->end) {
+
+        // Canonicalize the taskset (unless the generator already did) and get its utilization
+        if (item->num_canonical_tasks < 0)
+            item->num_canonical_tasks = canonicalize_taskset(item->tasks, item->num_tasks, item->canonical_tasks);
+        item->taskset_util = get_taskset_utilization(item->tasks, item->num_tasks);
+        stage_stats->num_items++;
+
+        lo_util_sum = 0.0;
+        hi_util_sum = 0.0;
+        for (int i = 0; i < item->num_canonical_tasks; i++) {
+            lo_util_sum += item->canonical_tasks[i].utilization[LO];
+            hi_util_sum += item->canonical_tasks[i].utilization[HI];
+        }
+
+        // Tasksets that fail Max{U_HI, U_LO} < 1.0: every test gives the result of MC-QPA's first check (the Iterative test is not run)
+        if (max(lo_util_sum, hi_util_sum) >= 1.0) {
+            schedulability_test_mcqpa(item->canonical_tasks, item->num_canonical_tasks, &item->schedulability_mcqpa, NULL);
+            item->schedulability_mcqpa.approx_fallback = 0;
+            item->schedulability_mcqpa.witness_hit = 0;
+            item->schedulability_raw = item->schedulability_mcqpa;
+            item->schedulability_approx = item->schedulability_mcqpa;
+            item->schedulability_portfolio = item->schedulability_mcqpa;
+            item->schedulability = item->schedulability_mcqpa;
+            item->winner = PORTFOLIO_MCQPA;
+            item->prefiltered = 1;
+            push_blocking(&pipeline->analysed, item, stage_stats);
+        }
+        else
+            push_blocking(&pipeline->prefiltered, item, stage_stats);
+    }
+
+    // End of the stream: one marker per worker
+    free(item);
+    for (int w = 0; w < pipeline->num_workers; w++)
+        push_blocking(&pipeline->prefiltered, new_end_marker(), stage_stats);
+    stage_stats->end = get_wall_time_ns();
+
+    return NULL;
+}
+
+// =====================
+// EXACT-TEST WORKER ADT
+// =====================
+
+// State of an exact-test worker, kept warm across tasksets
+typedef struct {
+    Workspace workspace;                 // Scratch memory of the tests
+    Portfolio portfolio;                 // Iterative and MC-QPA racing on the same taskset (PORTFOLIO)
+    Verification verification;           // Decides which MC-QPA verdicts are cross-checked against the Iterative test
+    WitnessPool witness_pool;            // Violation witnesses of the last NOT_SCHEDULABLE tasksets (input method 'f')
+    Profiler profiler;                   // Performance counters of the worker thread (PROFILING)
+} Worker;
+
+// Run every test on a taskset, as the sequential driver did (same tests, order and timers)
+
+static void analyse_taskset (Pipeline *pipeline, Worker *worker, PipelineItem *item) {
+
+    Workspace *workspace = &worker->workspace;
+
+    // Run MC-QPA on the taskset as given, to measure the effect of canonicalization (same verdict expected)
+    if (CANONICAL_COMPARE) {
+        item->t5 = get_cpu_time_ns();
+        schedulability_test_mcqpa(item->tasks, item->num_tasks, &item->schedulability_raw, workspace);
+        item->t5 = get_cpu_time_ns() - item->t5;
+    }
+
+    // The tests below read S(t) from the job lattice of the base taskset (MC-QPA (raw) merges S(t) from scratch)
+    if (item->has_lattice)
+        workspace->lattice = &item->lattice;
+
+    // Run MC-QPA test (Algorithm 2); for the input file, checking the violation witnesses of the previous tasksets first
+    // (consecutive tasksets of a file are often variants of each other, e.g. replays or wcet scalings)
+    if (PROFILING)
+        start_profiler(&worker->profiler);
+    item->t2 = get_cpu_time_ns();
+    if (pipeline->mode == 'f')
+        schedulability_test_witness(item->canonical_tasks, item->num_canonical_tasks, worker->witness_pool.witnesses, worker->witness_pool.num_witnesses, &item->schedulability_mcqpa, workspace);
+    else
+        schedulability_test_mcqpa(item->canonical_tasks, item->num_canonical_tasks, &item->schedulability_mcqpa, workspace);
+    item->t2 = get_cpu_time_ns() - item->t2;
+    if (PROFILING)
+        stop_profiler(&worker->profiler, item->profile_counts_mcqpa);
+    if (pipeline->mode == 'f')
+        add_witness(&worker->witness_pool, &item->schedulability_mcqpa);
+
+    // Run Approximate test (exact overall: falls back on MC-QPA when inconclusive)
+    if (APPROX_TEST) {
+        item->t3 = get_cpu_time_ns();
+        schedulability_test_approx(item->canonical_tasks, item->num_canonical_tasks, &item->schedulability_approx, workspace);
+        item->t3 = get_cpu_time_ns() - item->t3;
+    }
+
+    // Race Iterative and MC-QPA, keeping the first verdict (wall-clock time: the tests run on two threads)
+    if (PORTFOLIO) {
+        item->t4 = get_wall_time_ns();
+        item->winner = schedulability_test_portfolio(&worker->portfolio, item->canonical_tasks, item->num_canonical_tasks, &item->schedulability_portfolio);
+        item->t4 = get_wall_time_ns() - item->t4;
+    }
+
+    // Run Iterative test (Algorithm 1) only if the verification policy selects this taskset
+    item->verified = verification_required(&worker->verification, &item->schedulability_mcqpa);
+    item->schedulability.t_points = 0;
+    item->schedulability.t_s_points = 0;
+    item->schedulability.peak_memory = 0;
+    if (item->verified) {
+        if (PROFILING)
+            start_profiler(&worker->profiler);
+        item->t1 = get_cpu_time_ns();
+        schedulability_test(item->canonical_tasks, item->num_canonical_tasks, &item->schedulability, workspace);
+        item->t1 = get_cpu_time_ns() - item->t1;
+        if (PROFILING)
+            stop_profiler(&worker->profiler, item->profile_counts);
+    }
+
+    workspace->lattice = NULL;
+}
+
+// Exact-test worker stage
+
+static void* worker_thread (void *arg) {
+
+    Pipeline *pipeline = arg;
+    int index = atomic_fetch_add(&pipeline->next_worker, 1);    // Index of the worker
+    StageStats *stage_stats = &pipeline->worker_stats[index];
+    Worker worker;                       // Worker state
+    PipelineItem *item;                  // Taskset being analysed
+    int cell = -1;                       // Sweep cell of the last taskset analysed
+
+    stage_stats->start = get_wall_time_ns();
+    init_workspace(&worker.workspace);
+    if (PORTFOLIO)
+        init_portfolio(&worker.portfolio);
+    init_verification(&worker.verification, pipeline->verification_seed + index);
+    init_witness_pool(&worker.witness_pool);
+    if (PROFILING)
+        init_profiler(&worker.profiler);
+
+    while (!(item = pop_blocking(&pipeline->prefiltered, stage_stats))->end) {
+
+        // Skip the tasksets of cells that already have enough of them
+        if (item->cell < atomic_load(&pipeline->cells_done))
+            item->discarded = 1;
+
+        else {
+
+            // Per-cell verification strata
+            if (item->cell != cell) {
+                reset_verification_strata(&worker.verification);
+                cell = item->cell;
+            }
+
+            analyse_taskset(pipeline, &worker, item);
+            stage_stats->num_items++;
+        }
+
+        push_blocking(&pipeline->analysed, item, stage_stats);
+    }
+
+    // End of the stream: forward the marker to the aggregator
+    push_blocking(&pipeline->analysed, item, stage_stats);
+
+    if (PROFILING)
+        free_profiler(&worker.profiler);
+    close_verification(&worker.verification);
+    if (PORTFOLIO)
+        free_portfolio(&worker.portfolio);
+    free_workspace(&worker.workspace);
+    stage_stats->end = get_wall_time_ns();
+
+    return NULL;
+}
+
+// ====================
+// PIPELINE
+// ====================
+
+// Start the pipeline threads for the given input method
+
+void init_pipeline (Pipeline *pipeline, char mode, FILE *input_file, int num_tasksets, unsigned int verification_seed) {
+
+    // Precondition check
+    assert(pipeline != NULL && (mode == 't' || mode == 'f') && (mode == 't' || input_file != NULL));
+    assert(PIPELINE_NUM_WORKERS >= 0 && PIPELINE_NUM_WORKERS <= PIPELINE_MAX_WORKERS && PIPELINE_REORDER_SIZE > 0);
+
+    pipeline->mode = mode;
+    pipeline->input_file = input_file;
+    pipeline->num_tasksets = num_tasksets;
+    pipeline->verification_seed = verification_seed;
+    init_bounded_queue(&pipeline->generated, PIPELINE_QUEUE_SIZE);
+    init_bounded_queue(&pipeline->prefiltered, PIPELINE_QUEUE_SIZE);
+    init_bounded_queue(&pipeline->analysed, PIPELINE_QUEUE_SIZE);
+    atomic_init(&pipeline->cells_done, 0);
+    atomic_init(&pipeline->next_worker, 0);
+    for (int stage = 0; stage < PIPELINE_NUM_STAGES; stage++)
+        pipeline->stage_stats[stage] = (StageStats){0, 0, 0, 0, 0};
+
+    // Size the worker pool
+    pipeline->num_workers = PIPELINE_NUM_WORKERS;
+    if (pipeline->num_workers == 0)
+        pipeline->num_workers = min((int)sysconf(_SC_NPROCESSORS_ONLN), PIPELINE_MAX_WORKERS);
+    if (pipeline->num_workers <= 0)
+        pipeline->num_workers = 1;
+    for (int w = 0; w < pipeline->num_workers; w++)
+        pipeline->worker_stats[w] = (StageStats){0, 0, 0, 0, 0};
+    pipeline->base_pools = NULL;
+    pipeline->num_base_pools = 0;
+    pipeline->num_base_tasksets = 0;
+    pipeline->num_offsets = 0;
+    for (int slot = 0; slot < PIPELINE_REORDER_SIZE; slot++)
+        pipeline->pending[slot] = NULL;
+    atomic_init(&pipeline->next_sequence, 0);
+    pipeline->num_ended = 0;
+    pipeline->num_discarded = 0;
+    pipeline->num_prefiltered = 0;
+
+    // The calling thread is the aggregator
+    pipeline->stage_stats[PIPELINE_AGGREGATE].start = get_wall_time_ns();
+
+    pthread_create(&pipeline->generator, NULL, generator_thread, pipeline);
+    pthread_create(&pipeline->prefilter, NULL, prefilter_thread, pipeline);
+    for (int w = 0; w < pipeline->num_workers; w++)
+        pthread_create(&pipeline->workers[w], NULL, worker_thread, pipeline);
+}
+
+// Get the next analysed taskset in generation order, dropping the tasksets of the cells before the given one. Return NULL at the end of the stream
+
+PipelineItem* next_pipeline_item (Pipeline *pipeline, int cell) {
+
+    StageStats *stage_stats = &pipeline->stage_stats[PIPELINE_AGGREGATE];
+    PipelineItem *item;                  // Next taskset in generation order, or taskset received
+    long long int next_sequence = 0;     // Sequence of the next taskset to aggregate
+
+    while (1) {
+
+        // Hand over the next taskset in generation order once it has arrived (the generator may then run one taskset further ahead)
+        next_sequence = atomic_load(&pipeline->next_sequence);
+        item = pipeline->pending[next_sequence % PIPELINE_REORDER_SIZE];
+        if (item != NULL) {
+            pipeline->pending[next_sequence % PIPELINE_REORDER_SIZE] = NULL;
+            atomic_store(&pipeline->next_sequence, next_sequence + 1);
+
+            if (item->discarded || item->cell < cell) {
+                pipeline->num_discarded++;
+                free_pipeline_item(item);
+                continue;
+            }
+
+            assert(item->cell == cell);
+            pipeline->num_prefiltered += item->prefiltered;
+            stage_stats->num_items++;
+            return item;
+        }
+
+        // Wait for the next analysed taskset
+        if (pipeline->num_ended == pipeline->num_workers)
+            return NULL;
+        item = pop_blocking(&pipeline->analysed, stage_stats);
+        if (item->end) {
+            pipeline->num_ended++;
+            free(item);
+            continue;
+        }
+        assert(item->sequence >= next_sequence && item->sequence < next_sequence + PIPELINE_REORDER_SIZE);
+        pipeline->pending[item->sequence % PIPELINE_REORDER_SIZE] = item;
+    }
+}
+
+// Tell the generator that the given sweep cell has enough tasksets
+
+void finish_pipeline_cell (Pipeline *pipeline, int cell) {
+
+    atomic_store(&pipeline->cells_done, cell + 1);
+}
+
+// Drain the pipeline, join its threads and release it
+
+void free_pipeline (Pipeline *pipeline) {
+
+    PipelineItem *item;                  // Taskset left in the pipeline
+
+    pipeline->stage_stats[PIPELINE_AGGREGATE].end = get_wall_time_ns();
+
+    // Stop the generator and skip the remaining tasksets
+    atomic_store(&pipeline->cells_done, INT_MAX);
+    while ((item = next_pipeline_item(pipeline, INT_MAX)) != NULL)
+        free_pipeline_item(item);
+
+    pthread_join(pipeline->generator, NULL);
+    pthread_join(pipeline->prefilter, NULL);
+    for (int w = 0; w < pipeline->num_workers; w++)
+        pthread_join(pipeline->workers[w], NULL);
+
+    // Release the base tasksets (referenced by the tasksets in flight until now)
+    for (int p = 0; p < pipeline->num_base_pools; p++) {
+        pipeline->num_base_tasksets += pipeline->base_pools[p].num_bases;
+        pipeline->num_offsets += pipeline->base_pools[p].num_offsets;
+        free_base_taskset_pool(&pipeline->base_pools[p]);
+    }
+    free(pipeline->base_pools);
+    pipeline->base_pools = NULL;
+    pipeline->num_base_pools = 0;
+
+    free_bounded_queue(&pipeline->generated);
+    free_bounded_queue(&pipeline->prefiltered);
+    free_bounded_queue(&pipeline->analysed);
+}
+
+// Write the time, item count and utilization of every stage (after free_pipeline). The utilization is the fraction of the wall-clock time
+// a stage spent neither starved nor blocked, averaged over its threads
+
+void print_pipeline_stats (Pipeline *pipeline, FILE *output_fptr) {
+
+    const char *stage_names[PIPELINE_NUM_STAGES] = PIPELINE_STAGE_NAMES;
+    StageStats stage_stats;              // Times of a stage, summed over its threads
+    int num_threads = 0;                 // Number of threads of the stage
+    double wall_time = 0.0;              // Wall-clock time of the stage (s, summed over its threads)
+    double utilization = 0.0;            // Fraction of the wall-clock time spent working
+
+    fprintf(output_fptr, "\nPipeline stage,Threads,Tasksets,Wall time,Starved time,Blocked time,Utilization\n");
+    printf("\n Pipeline stages:\n");
+
+    for (int stage = 0; stage < PIPELINE_NUM_STAGES; stage++) {
+
+        // Sum the times of the threads of the stage
+        stage_stats = (StageStats){0, 0, 0, 0, 0};
+        num_threads = (stage == PIPELINE_ANALYZE) ? pipeline->num_workers : 1;
+        for (int thread = 0; thread < num_threads; thread++) {
+            const StageStats *thread_stats = (stage == PIPELINE_ANALYZE) ? &pipeline->worker_stats[thread] : &pipeline->stage_stats[stage];
+            stage_stats.end += thread_stats->end - thread_stats->start;
+            stage_stats.starved += thread_stats->starved;
+            stage_stats.blocked += thread_stats->blocked;
+            stage_stats.num_items += thread_stats->num_items;
+        }
+
+        wall_time = stage_stats.end / 1e9;
+        utilization = (stage_stats.end > 0) ? (stage_stats.end - stage_stats.starved - stage_stats.blocked) / (double)stage_stats.end : 0.0;
+
+        fprintf(output_fptr, "%s,%d,%lld,%lf,%lf,%lf,%lf\n", stage_names[stage], num_threads, stage_stats.num_items, wall_time, stage_stats.starved / 1e9, stage_stats.blocked / 1e9, utilization);
+        printf(" %s\t Threads: %d\t Tasksets: %lld\t Wall time: %lf\t Starved: %lf\t Blocked: %lf\t Utilization: %lf\n", stage_names[stage], num_threads, stage_stats.num_items, wall_time, stage_stats.starved / 1e9, stage_stats.blocked / 1e9, utilization);
+    }
+
+    fprintf(output_fptr, "\n Prefiltered tasksets: %lld\n Discarded tasksets: %lld\n", pipeline->num_prefiltered, pipeline->num_discarded);
+    printf(" Prefiltered tasksets: %lld\t Discarded tasksets: %lld\n", pipeline->num_prefiltered, pipeline->num_discarded);
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../inc/schedtest.h"
+#include "../inc/portfolio.h"
+
+// Portfolio execution of the exact tests
+//
+// Which exact test reaches the verdict first depends on the taskset: Iterative scans t upwards from 1 and wins when the violation is at
+// a small t, MC-QPA descends from B and wins on SCHEDULABLE tasksets. The portfolio races both on the same taskset (the tests only read
+// it, so no copy is needed), keeps the first verdict and cancels the other test through its workspace, so that the latency tracks the
+// faster test of every taskset. Both tests are exact, so the verdict does not depend on the winner.
+
+// Claim the win for the given test if it reached a verdict before the other one, and cancel the other test
+
+static void finish_test (Portfolio *portfolio, int test) {
+
+    int expected = -1;
+
+    if (portfolio->results[test].taskset_schedulability == CANCELLED)
+        return;
+
+    if (atomic_compare_exchange_strong(&portfolio->winner, &expected, test))
+        atomic_store(&portfolio->cancel[PORTFOLIO_NUM_TESTS - 1 - test], 1);
+}
+
+// Helper thread: runs Iterative on every taskset handed over by schedulability_test_portfolio
+
+static void* helper_thread (void *arg) {
+
+    Portfolio *portfolio = arg;
+
+    while (1) {
+
+        // Wait for the next taskset (or the termination request)
+        pthread_mutex_lock(&portfolio->mutex);
+        while (portfolio->state == PORTFOLIO_IDLE || portfolio->state == PORTFOLIO_DONE)
+            pthread_cond_wait(&portfolio->changed, &portfolio->mutex);
+        if (portfolio->state == PORTFOLIO_EXIT) {
+            pthread_mutex_unlock(&portfolio->mutex);
+            break;
+        }
+        pthread_mutex_unlock(&portfolio->mutex);
+
+        // Race against MC-QPA
+        schedulability_test(portfolio->tasks, portfolio->num_tasks, &portfolio->results[PORTFOLIO_ITERATIVE], &portfolio->workspaces[PORTFOLIO_ITERATIVE]);
+        finish_test(portfolio, PORTFOLIO_ITERATIVE);
+
+        // Report the end of the run
+        pthread_mutex_lock(&portfolio->mutex);
+        portfolio->state = PORTFOLIO_DONE;
+        pthread_cond_broadcast(&portfolio->changed);
+        pthread_mutex_unlock(&portfolio->mutex);
+    }
+
+    return NULL;
+}
+
+// Initialize the portfolio and start its helper thread
+
+void init_portfolio (Portfolio *portfolio) {
+
+    pthread_mutex_init(&portfolio->mutex, NULL);
+    pthread_cond_init(&portfolio->changed, NULL);
+    portfolio->state = PORTFOLIO_IDLE;
+    portfolio->tasks = NULL;
+    portfolio->num_tasks = 0;
+
+    // Each test polls its own cancel flag through its workspace
+    for (int i = 0; i < PORTFOLIO_NUM_TESTS; i++) {
+        init_workspace(&portfolio->workspaces[i]);
+        atomic_init(&portfolio->cancel[i], 0);
+        portfolio->workspaces[i].cancel = &portfolio->cancel[i];
+    }
+    atomic_init(&portfolio->winner, -1);
+
+    pthread_create(&portfolio->helper, NULL, helper_thread, portfolio);
+}
+
+// Race Iterative and MC-QPA on the given taskset, store the verdict of the first one to finish in schedulability and return
+// its index (PORTFOLIO_ITERATIVE or PORTFOLIO_MCQPA)
+
+int schedulability_test_portfolio (Portfolio *portfolio, const Tasks *tasks, int num_tasks, Schedulability *schedulability) {
+
+    int winner = -1;
+
+    // Reset the race
+    for (int i = 0; i < PORTFOLIO_NUM_TESTS; i++)
+        atomic_store(&portfolio->cancel[i], 0);
+    atomic_store(&portfolio->winner, -1);
+
+    // Hand the taskset over to the helper thread (Iterative)
+    pthread_mutex_lock(&portfolio->mutex);
+    portfolio->tasks = tasks;
+    portfolio->num_tasks = num_tasks;
+    portfolio->state = PORTFOLIO_RUNNING;
+    pthread_cond_broadcast(&portfolio->changed);
+    pthread_mutex_unlock(&portfolio->mutex);
+
+    // Run MC-QPA on the calling thread
+    schedulability_test_mcqpa(tasks, num_tasks, &portfolio->results[PORTFOLIO_MCQPA], &portfolio->workspaces[PORTFOLIO_MCQPA]);
+    finish_test(portfolio, PORTFOLIO_MCQPA);
+
+    // Wait for the helper thread to finish or notice the cancellation (at its next t point), so that the taskset may be released
+    pthread_mutex_lock(&portfolio->mutex);
+    while (portfolio->state != PORTFOLIO_DONE)
+        pthread_cond_wait(&portfolio->changed, &portfolio->mutex);
+    portfolio->state = PORTFOLIO_IDLE;
+    pthread_mutex_unlock(&portfolio->mutex);
+
+    // The winner always holds a verdict: a test is only cancelled by the other one once the latter has reached its verdict
+    winner = atomic_load(&portfolio->winner);
+    assert(winner == PORTFOLIO_ITERATIVE || winner == PORTFOLIO_MCQPA);
+    *schedulability = portfolio->results[winner];
+
+    return winner;
+}
+
+// Stop the helper thread and release the portfolio
+
+void free_portfolio (Portfolio *portfolio) {
+
+    pthread_mutex_lock(&portfolio->mutex);
+    portfolio->state = PORTFOLIO_EXIT;
+    pthread_cond_broadcast(&portfolio->changed);
+    pthread_mutex_unlock(&portfolio->mutex);
+    pthread_join(portfolio->helper, NULL);
+
+    for (int i = 0; i < PORTFOLIO_NUM_TESTS; i++)
+        free_workspace(&portfolio->workspaces[i]);
+    pthread_cond_destroy(&portfolio->changed);
+    pthread_mutex_destroy(&portfolio->mutex);
+}
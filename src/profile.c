@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <string.h>
+#include "../inc/profile.h"
+#include "../inc/latency.h"
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Performance counter profiling
+//
+// CPU time alone does not tell why a test got slower: more instructions per (t, s) point, branch mispredicts (e.g. on the task criticality)
+// or cache misses on the s points chunk. Each counter is a separate perf event of the calling thread (user space only), so that the counters
+// a virtual machine or the perf_event_paranoid setting does not provide are simply reported as unavailable. The task clock is always
+// available: when perf_event_open is not, it falls back on the thread CPU clock.
+
+#ifdef __linux__
+
+// Open a single perf event counting the calling thread in user space, disabled until start_profiler. Return its file descriptor, -1 on failure
+
+static int open_perf_event (unsigned int type, unsigned long long int config) {
+
+    struct perf_event_attr attr;         // Event description
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+#endif
+
+// Open the performance counters of the calling thread
+
+void init_profiler (Profiler *profiler) {
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        profiler->fds[counter] = -1;
+    profiler->start_cpu_time = 0;
+
+#ifdef __linux__
+    profiler->fds[PROFILE_CYCLES] = open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    profiler->fds[PROFILE_INSTRUCTIONS] = open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    profiler->fds[PROFILE_BRANCH_MISSES] = open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    profiler->fds[PROFILE_L1D_MISSES] = open_perf_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    profiler->fds[PROFILE_LLC_MISSES] = open_perf_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    profiler->fds[PROFILE_TASK_CLOCK] = open_perf_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+#endif
+}
+
+// Return 1 if the counter is available, else 0 (the task clock always is)
+
+int profiler_counter_available (const Profiler *profiler, int counter) {
+
+    return counter == PROFILE_TASK_CLOCK || profiler->fds[counter] >= 0;
+}
+
+// Reset and start the counters
+
+void start_profiler (Profiler *profiler) {
+
+#ifdef __linux__
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++) {
+        if (profiler->fds[counter] >= 0) {
+            ioctl(profiler->fds[counter], PERF_EVENT_IOC_RESET, 0);
+            ioctl(profiler->fds[counter], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+
+    profiler->start_cpu_time = get_cpu_time_ns();
+}
+
+// Stop the counters and store their values since start_profiler in counts
+
+void stop_profiler (Profiler *profiler, long long int counts[PROFILE_NUM_COUNTERS]) {
+
+    long long int cpu_time = get_cpu_time_ns() - profiler->start_cpu_time;    // Task clock fallback
+#ifdef __linux__
+    unsigned long long int values[3];                                          // Counter value, time enabled and time running
+#endif
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        counts[counter] = -1;
+
+#ifdef __linux__
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++) {
+        if (profiler->fds[counter] >= 0) {
+            ioctl(profiler->fds[counter], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(profiler->fds[counter], values, sizeof(values)) != sizeof(values))
+                continue;
+
+            // Scale the value up if the kernel multiplexed the counter (more events than hardware counters)
+            if (values[2] > 0 && values[2] < values[1])
+                values[0] = (unsigned long long int)((double)values[0] * values[1] / values[2]);
+            counts[counter] = (long long int)values[0];
+        }
+    }
+#endif
+
+    if (counts[PROFILE_TASK_CLOCK] < 0)
+        counts[PROFILE_TASK_CLOCK] = cpu_time;
+}
+
+// Close the performance counters
+
+void free_profiler (Profiler *profiler) {
+
+#ifdef __linux__
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        if (profiler->fds[counter] >= 0)
+            close(profiler->fds[counter]);
+#endif
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        profiler->fds[counter] = -1;
+}
+
+// Reset the aggregated counters
+
+void init_profile_stats (ProfileStats *profile_stats) {
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        profile_stats->counts[counter] = 0;
+    profile_stats->num_tasksets = 0;
+    profile_stats->t_points = 0;
+    profile_stats->t_s_points = 0;
+}
+
+// Add the counters of a test call on a taskset (a counter that was unavailable once stays unavailable for the whole cell)
+
+void add_profile_sample (ProfileStats *profile_stats, const long long int counts[PROFILE_NUM_COUNTERS], const Schedulability *schedulability) {
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++) {
+        if (counts[counter] < 0 || profile_stats->counts[counter] < 0)
+            profile_stats->counts[counter] = -1;
+        else
+            profile_stats->counts[counter] += counts[counter];
+    }
+
+    profile_stats->num_tasksets++;
+    profile_stats->t_points += schedulability->t_points;
+    profile_stats->t_s_points += schedulability->t_s_points;
+}
+
+// Write the column headings of the profile file
+
+void print_profile_header (FILE *profile_fptr) {
+
+    const char *counter_names[PROFILE_NUM_COUNTERS] = PROFILE_COUNTER_NAMES;
+
+    fprintf(profile_fptr, "Criticality Proportion,Taskset Utilization,Algorithm,Tasksets,Interval lengths,Pair-points");
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++)
+        fprintf(profile_fptr, ",%s,%s per interval length,%s per pair-point", counter_names[counter], counter_names[counter], counter_names[counter]);
+    fprintf(profile_fptr, ",Instructions per cycle\n");
+}
+
+// Append a line of aggregated counters to the profile file: for each counter, its total, per t point and per (t, s) point values
+
+void print_profile_stats (FILE *profile_fptr, double criticality_proportion, double taskset_utilization, const char *algorithm, const ProfileStats *profile_stats) {
+
+    const long long int *counts = profile_stats->counts;
+
+    fprintf(profile_fptr, "%lf,%lf,%s,%d,%lld,%lld", criticality_proportion, taskset_utilization, algorithm, profile_stats->num_tasksets, profile_stats->t_points, profile_stats->t_s_points);
+
+    for (int counter = 0; counter < PROFILE_NUM_COUNTERS; counter++) {
+        if (counts[counter] < 0)
+            fprintf(profile_fptr, ",n/a,n/a,n/a");
+        else
+            fprintf(profile_fptr, ",%lld,%lf,%lf", counts[counter], (profile_stats->t_points > 0) ? counts[counter] / (double)profile_stats->t_points : 0.0,
+                    (profile_stats->t_s_points > 0) ? counts[counter] / (double)profile_stats->t_s_points : 0.0);
+    }
+
+    // Instructions per cycle
+    if (counts[PROFILE_CYCLES] > 0 && counts[PROFILE_INSTRUCTIONS] >= 0)
+        fprintf(profile_fptr, ",%lf\n", counts[PROFILE_INSTRUCTIONS] / (double)counts[PROFILE_CYCLES]);
+    else
+        fprintf(profile_fptr, ",n/a\n");
+}
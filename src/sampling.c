@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../inc/tasks.h"
+#include "../inc/sampling.h"
+
+// Initialize the running sums of a sweep cell with the compile-time selected policy
+
+void init_sampling (Sampling *sampling) {
+
+    sampling->policy = SAMPLING_POLICY;
+    sampling->num_samples = 0;
+    sampling->sum_u = 0.0;
+    sampling->sum_ux = 0.0;
+    sampling->sum_u2 = 0.0;
+    sampling->sum_u2x = 0.0;
+}
+
+// Add a taskset with the given utilization and schedulability (1 --> SCHEDULABLE) to the running sums
+
+void add_sample (Sampling *sampling, double taskset_utilization, int schedulable) {
+
+    sampling->num_samples++;
+    sampling->sum_u += taskset_utilization;
+    sampling->sum_u2 += taskset_utilization * taskset_utilization;
+    if (schedulable) {
+        sampling->sum_ux += taskset_utilization;
+        sampling->sum_u2x += taskset_utilization * taskset_utilization;
+    }
+}
+
+// Get the half-width of the weighted schedulability confidence interval (delta method, rule of three if all verdicts agree), 1.0 on fewer than 2 samples
+// Var(R) ~ sum((ui * xi - R * ui)^2) / ((n - 1) * n * mean(u)^2), where sum((ui * xi - R * ui)^2) = sum(ui^2 * xi) (1 - 2R) + R^2 sum(ui^2) as xi^2 = xi
+
+double get_ci_half_width (const Sampling *sampling) {
+
+    double n = sampling->num_samples;    // Number of tasksets
+    double ratio = 0.0;                  // Weighted schedulability R
+    double sum_squares = 0.0;            // sum((ui * xi - R * ui)^2)
+    double mean_u = 0.0;                 // mean(u)
+
+    if (sampling->num_samples < 2 || sampling->sum_u <= 0.0)
+        return 1.0;
+
+    ratio = sampling->sum_ux / sampling->sum_u;
+
+    // All tasksets share the same verdict: the interval degenerates to a point, use the rule of three bound (95%) instead
+    if (sampling->sum_ux == 0.0 || sampling->sum_ux == sampling->sum_u)
+        return 3.0 / n;
+
+    mean_u = sampling->sum_u / n;
+    sum_squares = sampling->sum_u2x * (1.0 - 2.0 * ratio) + ratio * ratio * sampling->sum_u2;
+
+    // Guard against rounding below 0
+    if (sum_squares < 0.0)
+        sum_squares = 0.0;
+
+    return SAMPLING_Z * sqrt(sum_squares / ((n - 1.0) * n * mean_u * mean_u));
+}
+
+// Get the largest number of tasksets the sweep cell may need
+
+int get_max_samples (const Sampling *sampling) {
+
+    if (sampling->policy == SAMPLING_FIXED)
+        return NUM_TASKSETS;
+
+    return (SAMPLING_MAX_TASKSETS > SAMPLING_MIN_TASKSETS) ? SAMPLING_MAX_TASKSETS : SAMPLING_MIN_TASKSETS;
+}
+
+// Return 1 if the sweep cell needs more tasksets, else 0
+
+int sampling_required (const Sampling *sampling) {
+
+    if (sampling->policy == SAMPLING_FIXED)
+        return sampling->num_samples < NUM_TASKSETS;
+
+    // SAMPLING_ADAPTIVE: at least SAMPLING_MIN_TASKSETS, then until the interval is narrow enough or SAMPLING_MAX_TASKSETS is reached
+    if (sampling->num_samples < SAMPLING_MIN_TASKSETS)
+        return 1;
+    if (sampling->num_samples >= SAMPLING_MAX_TASKSETS)
+        return 0;
+
+    return 2.0 * get_ci_half_width(sampling) > SAMPLING_CI_WIDTH;
+}
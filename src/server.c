@@ -0,0 +1,649 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../inc/server.h"
+#include "../inc/generator.h"
+#include "../inc/auxiliary.h"
+#include "../inc/schedtest.h"
+
+// Request line protocol (one taskset per line, same parameters and order as the input file):
+//    <number of tasks> <period> <deadline> <criticality> <wcet[LO]> <wcet[HI]> ... <period> <deadline> <criticality> <wcet[LO]> <wcet[HI]>
+// Response line (one per request, in request order on each connection):
+//    <schedulability> <floor(B)> <number of t points> <number of (t, s) points>
+// where schedulability is SCHEDULABLE (1), NOT_SCHEDULABLE (0) or DEFAULT (-1) if the request line is invalid.
+// Several request lines may be sent without waiting for the responses (pipelining).
+
+// =====================
+// CLIENT CONNECTION ADT
+// =====================
+
+// Client connection handed over to a connection thread
+typedef struct {
+    Server *server;
+    int fd;                              // Connected socket
+} Connection;
+
+// Benchmark client state
+typedef struct {
+    int fd;                              // Connected socket
+    char **lines;                        // Request lines (sent round robin)
+    int num_lines;                       // Number of distinct request lines
+    double rate;                         // Request rate of this client (requests per second)
+    int num_requests;                    // Number of requests to be sent
+    struct timespec start;               // Common start time of all clients
+    long long int *latencies;            // Latency of each request (ns), measured from its scheduled send time
+    long long int last_response;         // Time of the last response (ns since start)
+} BenchClient;
+
+// Time elapsed since the given start time, in nanoseconds
+
+static long long int elapsed_ns (const struct timespec *start) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000LL + (now.tv_nsec - start->tv_nsec);
+}
+
+// Write the whole buffer to the file descriptor. Return 0 on success, -1 on error
+
+static int write_all (int fd, const char *buffer, size_t length) {
+
+    ssize_t written = 0;
+
+    while (length > 0) {
+        written = write(fd, buffer, length);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return -1;
+        buffer += written;
+        length -= written;
+    }
+
+    return 0;
+}
+
+// ===========================
+// REQUEST QUEUE AND WORKERS
+// ===========================
+
+// Append requests to the queue, blocking while it is full (backpressure on the connections)
+
+static void enqueue_requests (RequestQueue *queue, Request *requests, int num_requests) {
+
+    pthread_mutex_lock(&queue->mutex);
+
+    for (int i = 0; i < num_requests; i++) {
+
+        while (queue->count == queue->capacity)
+            pthread_cond_wait(&queue->not_full, &queue->mutex);
+
+        queue->requests[(queue->head + queue->count) % queue->capacity] = &requests[i];
+        queue->count++;
+
+        pthread_cond_signal(&queue->not_empty);
+    }
+
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+// Remove a batch of at most SERVER_BATCH_SIZE requests from the queue, blocking while it is empty. Return the batch size (0 on shutdown)
+
+static int dequeue_batch (RequestQueue *queue, Request **batch) {
+
+    int batch_size = 0;
+
+    pthread_mutex_lock(&queue->mutex);
+
+    while (queue->count == 0 && !queue->shutdown)
+        pthread_cond_wait(&queue->not_empty, &queue->mutex);
+
+    // Coalesce all the pending requests (up to SERVER_BATCH_SIZE) into a single batch
+    while (queue->count > 0 && batch_size < SERVER_BATCH_SIZE) {
+        batch[batch_size++] = queue->requests[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+    }
+
+    if (batch_size > 0) {
+        queue->num_requests += batch_size;
+        queue->num_batches++;
+        pthread_cond_broadcast(&queue->not_full);
+    }
+
+    pthread_mutex_unlock(&queue->mutex);
+
+    return batch_size;
+}
+
+// Worker thread: analyse batches of requests with a warm analysis context
+
+static void* worker_thread (void *arg) {
+
+    Server *server = arg;
+    McqpaContext *context = mcqpa_context_create();    // Kept warm across all the requests served by this worker
+    Request *batch[SERVER_BATCH_SIZE];                  // Current batch of requests
+    int batch_size = 0;
+    RequestGroup *group;
+
+    assert(context != NULL);
+
+    while ((batch_size = dequeue_batch(&server->queue, batch)) > 0) {
+
+        // Analyse the whole batch
+        for (int i = 0; i < batch_size; i++)
+            batch[i]->status = mcqpa_analyze(context, batch[i]->taskset, MCQPA_TEST_MCQPA, &batch[i]->result);
+
+        // Then complete the requests, waking up a connection once its whole group is analysed
+        for (int i = 0; i < batch_size; i++) {
+            group = batch[i]->group;
+            pthread_mutex_lock(&group->mutex);
+            if (--group->remaining == 0)
+                pthread_cond_signal(&group->done);
+            pthread_mutex_unlock(&group->mutex);
+        }
+    }
+
+    mcqpa_context_destroy(context);
+
+    return NULL;
+}
+
+// ===================
+// CONNECTION HANDLING
+// ===================
+
+// Parse a request line into an immutable taskset. Return NULL if the line is invalid
+
+static McqpaTaskset* parse_request (const char *line) {
+
+    char *end;
+    long num_tasks = 0;
+    McqpaTaskParams *params;
+    McqpaTaskset *taskset = NULL;
+    int valid = 1;
+
+    num_tasks = strtol(line, &end, 10);
+    if (end == line || num_tasks <= 0 || num_tasks > 1000000)
+        return NULL;
+
+    params = malloc(num_tasks * sizeof(McqpaTaskParams));
+
+    for (int i = 0; i < num_tasks && valid; i++) {
+        line = end; params[i].period = (int)strtol(line, &end, 10); valid = valid && (end != line);
+        line = end; params[i].deadline = (int)strtol(line, &end, 10); valid = valid && (end != line);
+        line = end; params[i].criticality = (int)strtol(line, &end, 10); valid = valid && (end != line);
+        line = end; params[i].wcet_lo = strtod(line, &end); valid = valid && (end != line);
+        line = end; params[i].wcet_hi = strtod(line, &end); valid = valid && (end != line);
+    }
+
+    // mcqpa_taskset_create validates the task parameters themselves
+    if (valid)
+        taskset = mcqpa_taskset_create(params, (int)num_tasks);
+
+    free(params);
+
+    return taskset;
+}
+
+// Serve the requests read from in_fd, writing the responses to out_fd, until end of file
+// All the complete request lines available at once are enqueued together, so that concurrent (and pipelined) requests are batched
+
+void serve_connection (Server *server, int in_fd, int out_fd) {
+
+    size_t capacity = SERVER_READ_SIZE;      // Receive buffer capacity
+    char *buffer = malloc(capacity + 1);     // Receive buffer (NUL terminated)
+    size_t length = 0;                       // Number of bytes in the receive buffer
+    ssize_t num_read = 0;
+    char *line, *newline;
+    int num_requests = 0;
+    Request *requests;
+    RequestGroup group;
+    char *responses;                         // Response buffer (at most 4 numbers per request)
+    size_t responses_length = 0;
+    int failed = 0;
+
+    pthread_mutex_init(&group.mutex, NULL);
+    pthread_cond_init(&group.done, NULL);
+
+    while (!failed) {
+
+        // Grow the receive buffer if a single request line does not fit
+        if (length == capacity) {
+            capacity *= 2;
+            buffer = realloc(buffer, capacity + 1);
+        }
+
+        num_read = read(in_fd, buffer + length, capacity - length);
+        if (num_read < 0 && errno == EINTR)
+            continue;
+        if (num_read <= 0)
+            break;
+        length += num_read;
+        buffer[length] = '\0';
+
+        // Count the complete request lines received
+        num_requests = 0;
+        for (line = buffer; (newline = memchr(line, '\n', buffer + length - line)) != NULL; line = newline + 1)
+            num_requests++;
+        if (num_requests == 0)
+            continue;
+
+        // Parse them
+        requests = malloc(num_requests * sizeof(Request));
+        group.remaining = 0;
+        line = buffer;
+        for (int i = 0; i < num_requests; i++) {
+            newline = memchr(line, '\n', buffer + length - line);
+            *newline = '\0';
+            requests[i].taskset = parse_request(line);
+            requests[i].status = MCQPA_EINVAL;
+            requests[i].group = &group;
+            if (requests[i].taskset != NULL)
+                group.remaining++;
+            line = newline + 1;
+        }
+
+        // Enqueue the valid requests and wait for the whole group to be analysed
+        for (int i = 0; i < num_requests; i++) {
+            if (requests[i].taskset != NULL)
+                enqueue_requests(&server->queue, &requests[i], 1);
+        }
+        pthread_mutex_lock(&group.mutex);
+        while (group.remaining > 0)
+            pthread_cond_wait(&group.done, &group.mutex);
+        pthread_mutex_unlock(&group.mutex);
+
+        // Write the responses in request order
+        responses = malloc(num_requests * 96 + 1);
+        responses_length = 0;
+        for (int i = 0; i < num_requests; i++) {
+            if (requests[i].status == MCQPA_OK)
+                responses_length += sprintf(responses + responses_length, "%d %lld %lld %lld\n", requests[i].result.schedulable ? SCHEDULABLE : NOT_SCHEDULABLE, (long long int)requests[i].result.interval_length, requests[i].result.t_points, requests[i].result.t_s_points);
+            else
+                responses_length += sprintf(responses + responses_length, "%d 0 0 0\n", DEFAULT);
+            mcqpa_taskset_destroy(requests[i].taskset);
+        }
+        failed = write_all(out_fd, responses, responses_length) != 0;
+        free(responses);
+        free(requests);
+
+        // Keep the incomplete trailing line for the next read
+        length -= line - buffer;
+        memmove(buffer, line, length);
+    }
+
+    pthread_cond_destroy(&group.done);
+    pthread_mutex_destroy(&group.mutex);
+    free(buffer);
+}
+
+// Connection thread: serve a single client connection
+
+static void* connection_thread (void *arg) {
+
+    Connection *connection = arg;
+    Server *server = connection->server;
+
+    serve_connection(server, connection->fd, connection->fd);
+
+    // Unregister the connection (closing its socket under the lock, so that stop_server never shuts down a reused descriptor)
+    pthread_mutex_lock(&server->connections_mutex);
+    for (int i = 0; i < server->num_connections; i++) {
+        if (server->connection_fds[i] == connection->fd) {
+            server->connection_fds[i] = server->connection_fds[--server->num_connections];
+            break;
+        }
+    }
+    close(connection->fd);
+    if (server->num_connections == 0)
+        pthread_cond_broadcast(&server->connections_done);
+    pthread_mutex_unlock(&server->connections_mutex);
+    free(connection);
+
+    return NULL;
+}
+
+// Acceptor thread: hand every client connection over to its own connection thread
+
+static void* acceptor_thread (void *arg) {
+
+    Server *server = arg;
+    Connection *connection;
+    pthread_t thread;
+    int fd = 0;
+
+    while ((fd = accept(server->listen_fd, NULL, NULL)) >= 0 || errno == EINTR || errno == ECONNABORTED) {
+        if (fd < 0)
+            continue;
+        connection = malloc(sizeof(Connection));
+        connection->server = server;
+        connection->fd = fd;
+
+        // Register the connection, so that stop_server can wait for it
+        pthread_mutex_lock(&server->connections_mutex);
+        if (server->num_connections == server->connections_capacity) {
+            server->connections_capacity *= 2;
+            server->connection_fds = realloc(server->connection_fds, server->connections_capacity * sizeof(int));
+        }
+        server->connection_fds[server->num_connections++] = fd;
+        pthread_mutex_unlock(&server->connections_mutex);
+
+        pthread_create(&thread, NULL, connection_thread, connection);
+        pthread_detach(thread);
+    }
+
+    return NULL;
+}
+
+// ==================
+// SERVER LIFE CYCLE
+// ==================
+
+// Start the worker pool, and accept connections on the Unix domain socket socket_path (unless NULL). Return the server
+
+Server* start_server (const char *socket_path, int num_workers) {
+
+    Server *server = malloc(sizeof(Server));
+    struct sockaddr_un address;
+    int status = 0;
+
+    // Precondition check
+    assert(server != NULL && (socket_path == NULL || strlen(socket_path) < sizeof(address.sun_path)));
+
+    // A client closing its connection early must not terminate the server
+    signal(SIGPIPE, SIG_IGN);
+
+    // Initialize the request queue
+    server->queue.requests = malloc(SERVER_QUEUE_SIZE * sizeof(Request *));
+    server->queue.capacity = SERVER_QUEUE_SIZE;
+    server->queue.head = 0;
+    server->queue.count = 0;
+    server->queue.shutdown = 0;
+    server->queue.num_requests = 0;
+    server->queue.num_batches = 0;
+    pthread_mutex_init(&server->queue.mutex, NULL);
+    pthread_cond_init(&server->queue.not_empty, NULL);
+    pthread_cond_init(&server->queue.not_full, NULL);
+
+    // Initialize the connection registry
+    server->connections_capacity = 16;
+    server->connection_fds = malloc(server->connections_capacity * sizeof(int));
+    server->num_connections = 0;
+    pthread_mutex_init(&server->connections_mutex, NULL);
+    pthread_cond_init(&server->connections_done, NULL);
+
+    // Start the worker pool
+    if (num_workers <= 0)
+        num_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers <= 0)
+        num_workers = 1;
+    server->num_workers = num_workers;
+    server->workers = malloc(num_workers * sizeof(pthread_t));
+    for (int i = 0; i < num_workers; i++)
+        pthread_create(&server->workers[i], NULL, worker_thread, server);
+
+    // Listen on the Unix domain socket
+    server->listen_fd = -1;
+    server->socket_path[0] = '\0';
+    if (socket_path != NULL) {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, socket_path);
+        strcpy(server->socket_path, socket_path);
+        unlink(socket_path);
+
+        server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(server->listen_fd >= 0 && "Error creating the server socket");
+        status = bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address));
+        assert(status == 0 && "Error binding the server socket");
+        status = listen(server->listen_fd, SERVER_LISTEN_BACKLOG);
+        assert(status == 0 && "Error listening on the server socket");
+
+        pthread_create(&server->acceptor, NULL, acceptor_thread, server);
+    }
+
+    return server;
+}
+
+// Stop accepting connections, wait for the live connections, drain the queue and stop the workers
+
+void stop_server (Server *server) {
+
+    // Stop accepting connections
+    if (server->listen_fd >= 0) {
+        shutdown(server->listen_fd, SHUT_RDWR);
+        close(server->listen_fd);
+        pthread_join(server->acceptor, NULL);
+        unlink(server->socket_path);
+    }
+
+    // Stop reading from the live connections (their pending requests are still answered) and wait for their threads to exit
+    pthread_mutex_lock(&server->connections_mutex);
+    for (int i = 0; i < server->num_connections; i++)
+        shutdown(server->connection_fds[i], SHUT_RD);
+    while (server->num_connections > 0)
+        pthread_cond_wait(&server->connections_done, &server->connections_mutex);
+    pthread_mutex_unlock(&server->connections_mutex);
+
+    // Stop the workers once the queue is drained
+    pthread_mutex_lock(&server->queue.mutex);
+    server->queue.shutdown = 1;
+    pthread_cond_broadcast(&server->queue.not_empty);
+    pthread_mutex_unlock(&server->queue.mutex);
+    for (int i = 0; i < server->num_workers; i++)
+        pthread_join(server->workers[i], NULL);
+
+    // Free allocated memory
+    pthread_cond_destroy(&server->queue.not_full);
+    pthread_cond_destroy(&server->queue.not_empty);
+    pthread_mutex_destroy(&server->queue.mutex);
+    pthread_cond_destroy(&server->connections_done);
+    pthread_mutex_destroy(&server->connections_mutex);
+    free(server->connection_fds);
+    free(server->queue.requests);
+    free(server->workers);
+    free(server);
+}
+
+// Run the server on the Unix domain socket socket_path (forever), or on stdin/stdout if socket_path is NULL (until end of file)
+
+void run_server (const char *socket_path) {
+
+    Server *server = start_server(socket_path, SERVER_NUM_WORKERS);
+
+    if (socket_path != NULL) {
+        fprintf(stderr, " Analysis server listening on \"%s\" with %d workers\n", socket_path, server->num_workers);
+        pthread_join(server->acceptor, NULL);
+    }
+    else
+        serve_connection(server, STDIN_FILENO, STDOUT_FILENO);
+
+    stop_server(server);
+}
+
+// =========
+// BENCHMARK
+// =========
+
+// Scheduled send time of the given request (ns since start). Computed by both the sender and the receiver, which therefore share no timestamps
+
+static long long int get_send_time (const BenchClient *client, int request) {
+    return (long long int)(request * 1000000000.0 / client->rate);
+}
+
+// Benchmark sender: write the requests at their scheduled send times (open loop, independent of the responses)
+
+static void* bench_sender_thread (void *arg) {
+
+    BenchClient *client = arg;
+    struct timespec send_time;
+    long long int scheduled = 0;         // Scheduled send time of the current request (ns since start)
+    char *line;
+
+    for (int i = 0; i < client->num_requests; i++) {
+
+        // Sleep until the scheduled send time
+        scheduled = get_send_time(client, i);
+        send_time.tv_sec = client->start.tv_sec + (client->start.tv_nsec + scheduled) / 1000000000LL;
+        send_time.tv_nsec = (client->start.tv_nsec + scheduled) % 1000000000LL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &send_time, NULL) == EINTR);
+
+        line = client->lines[i % client->num_lines];
+        if (write_all(client->fd, line, strlen(line)) != 0)
+            break;
+    }
+
+    return NULL;
+}
+
+// Benchmark client: send the requests and record the latency of each response
+
+static void* bench_client_thread (void *arg) {
+
+    BenchClient *client = arg;
+    pthread_t sender;
+    char buffer[4096];
+    ssize_t num_read = 0;
+    int num_received = 0;
+
+    pthread_create(&sender, NULL, bench_sender_thread, client);
+
+    // Every response line completes the oldest outstanding request
+    while (num_received < client->num_requests && (num_read = read(client->fd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < num_read; i++) {
+            if (buffer[i] == '\n') {
+                client->last_response = elapsed_ns(&client->start);
+                client->latencies[num_received] = client->last_response - get_send_time(client, num_received);
+                num_received++;
+            }
+        }
+    }
+
+    pthread_join(sender, NULL);
+    client->num_requests = num_received;
+
+    return NULL;
+}
+
+// Measure the server latency percentiles and throughput at different request rates, print the results to the terminal and the output file
+
+void run_server_benchmark (FILE *output_file) {
+
+    double rates[BENCH_NUM_RATES] = BENCH_RATES;      // Request rates measured
+    char socket_path[108];                            // Temporary socket of the benchmarked server
+    Server *server;
+    Tasks *tasks;
+    char **lines;                                     // Request lines of the generated tasksets
+    size_t line_length = 0;
+    BenchClient clients[BENCH_NUM_CLIENTS];
+    pthread_t threads[BENCH_NUM_CLIENTS];
+    struct sockaddr_un address;
+    struct timespec start;
+    long long int *latencies;                         // Latencies of all the requests at the current rate
+    int num_latencies = 0;
+    long long int duration = 0;                       // Time of the last response at the current rate (ns)
+    long long int num_requests = 0, num_batches = 0;
+    double throughput = 0.0;
+    int status = 0;
+
+    // Generate the tasksets and serialize them into request lines
+    srand(time(0));
+    tasks = malloc(NUM_TASKS * sizeof(Tasks));
+    lines = malloc(BENCH_NUM_TASKSETS * sizeof(char *));
+    for (int i = 0; i < BENCH_NUM_TASKSETS; i++) {
+        task_parameter_generator(tasks, NUM_TASKS, BENCH_UTILIZATION, BENCH_CRITICALITY_PROPORTION);
+        lines[i] = malloc(16 + NUM_TASKS * 96);
+        line_length = sprintf(lines[i], "%d", NUM_TASKS);
+        for (int j = 0; j < NUM_TASKS; j++)
+            line_length += sprintf(lines[i] + line_length, " %d %d %d %.17g %.17g", tasks[j].period, tasks[j].deadline, tasks[j].criticality, tasks[j].wcet[LO], tasks[j].wcet[HI]);
+        sprintf(lines[i] + line_length, "\n");
+    }
+    free(tasks);
+
+    // Start the server on a temporary socket
+    snprintf(socket_path, sizeof(socket_path), "/tmp/mcqpa-bench-%d.sock", (int)getpid());
+    server = start_server(socket_path, SERVER_NUM_WORKERS);
+
+    // Print output file headings
+    fprintf(output_file, "Request rate,Throughput,p50 latency (us),p99 latency (us),Max latency (us),Mean batch size\n");
+    printf("\n Server benchmark: %d workers, %d clients, %d tasks per taskset, utilization %lf, criticality proportion %lf\n", server->num_workers, BENCH_NUM_CLIENTS, NUM_TASKS, BENCH_UTILIZATION, BENCH_CRITICALITY_PROPORTION);
+
+    // For all request rates
+    for (int r = 0; r < BENCH_NUM_RATES; r++) {
+
+        // Connect the clients
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, socket_path);
+        for (int c = 0; c < BENCH_NUM_CLIENTS; c++) {
+            clients[c].fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            status = connect(clients[c].fd, (struct sockaddr *)&address, sizeof(address));
+            assert(clients[c].fd >= 0 && status == 0 && "Error connecting to the benchmarked server");
+            clients[c].lines = lines;
+            clients[c].num_lines = BENCH_NUM_TASKSETS;
+            clients[c].rate = rates[r] / BENCH_NUM_CLIENTS;
+            clients[c].num_requests = (int)(clients[c].rate * BENCH_DURATION);
+            clients[c].latencies = malloc(clients[c].num_requests * sizeof(long long int));
+            clients[c].last_response = 0;
+        }
+
+        pthread_mutex_lock(&server->queue.mutex);
+        num_requests = server->queue.num_requests;
+        num_batches = server->queue.num_batches;
+        pthread_mutex_unlock(&server->queue.mutex);
+
+        // Run the clients from a common start time
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int c = 0; c < BENCH_NUM_CLIENTS; c++) {
+            clients[c].start = start;
+            pthread_create(&threads[c], NULL, bench_client_thread, &clients[c]);
+        }
+
+        // Gather the latencies
+        latencies = malloc((size_t)(rates[r] * BENCH_DURATION + BENCH_NUM_CLIENTS) * sizeof(long long int));
+        num_latencies = 0;
+        duration = 0;
+        for (int c = 0; c < BENCH_NUM_CLIENTS; c++) {
+            pthread_join(threads[c], NULL);
+            close(clients[c].fd);
+            memcpy(latencies + num_latencies, clients[c].latencies, clients[c].num_requests * sizeof(long long int));
+            num_latencies += clients[c].num_requests;
+            if (duration < clients[c].last_response)
+                duration = clients[c].last_response;
+            free(clients[c].latencies);
+        }
+
+        pthread_mutex_lock(&server->queue.mutex);
+        num_requests = server->queue.num_requests - num_requests;
+        num_batches = server->queue.num_batches - num_batches;
+        pthread_mutex_unlock(&server->queue.mutex);
+
+        // Latency percentiles
+        qsort(latencies, num_latencies, sizeof(long long int), sort_comparator);
+        throughput = (duration > 0) ? num_latencies / (duration / 1e9) : 0.0;
+
+        if (num_latencies > 0) {
+            printf(" Request rate: %lf\t Throughput: %lf\t p50 latency: %lf us\t p99 latency: %lf us\t Max latency: %lf us\t Mean batch size: %lf\n", rates[r], throughput, latencies[(int)(0.50 * (num_latencies - 1))] / 1e3, latencies[(int)(0.99 * (num_latencies - 1))] / 1e3, latencies[num_latencies - 1] / 1e3, (num_batches > 0) ? (double)num_requests / num_batches : 0.0);
+            fprintf(output_file, "%lf,%lf,%lf,%lf,%lf,%lf\n", rates[r], throughput, latencies[(int)(0.50 * (num_latencies - 1))] / 1e3, latencies[(int)(0.99 * (num_latencies - 1))] / 1e3, latencies[num_latencies - 1] / 1e3, (num_batches > 0) ? (double)num_requests / num_batches : 0.0);
+        }
+
+        free(latencies);
+    }
+
+    stop_server(server);
+
+    // Free allocated memory
+    for (int i = 0; i < BENCH_NUM_TASKSETS; i++)
+        free(lines[i]);
+    free(lines);
+}
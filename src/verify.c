@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "../inc/verify.h"
+
+// Initialize the verification state with the compile-time selected policy
+
+void init_verification (Verification *verification, unsigned int seed) {
+
+    // Precondition check
+    assert(verification != NULL && VERIFICATION_FRACTION >= 0.0 && VERIFICATION_FRACTION <= 1.0);
+
+    verification->policy = VERIFICATION_POLICY;
+    verification->fraction = VERIFICATION_FRACTION;
+    verification->b_limit = VERIFICATION_B_LIMIT;
+    verification->seed = seed;
+    verification->num_mismatches = 0;
+    verification->mismatch_file = NULL;
+
+    reset_verification_strata(verification);
+}
+
+// Reset the per-stratum counters (called at the start of every sweep cell)
+
+void reset_verification_strata (Verification *verification) {
+
+    verification->num_seen[NOT_SCHEDULABLE] = 0;
+    verification->num_seen[SCHEDULABLE] = 0;
+    verification->num_verified[NOT_SCHEDULABLE] = 0;
+    verification->num_verified[SCHEDULABLE] = 0;
+}
+
+// Decide whether the taskset analysed by MC-QPA must also be cross-checked by the Iterative test
+
+int verification_required (Verification *verification, Schedulability *schedulability_mcqpa) {
+
+    int verdict = schedulability_mcqpa->taskset_schedulability;    // MC-QPA verdict, used as the stratum index
+    int required = 0;                                              // Set to 1 if the taskset must be cross-checked
+
+    // Precondition check
+    assert(verdict == SCHEDULABLE || verdict == NOT_SCHEDULABLE);
+
+    switch (verification->policy) {
+
+        case VERIFY_ALL:
+            required = 1;
+            break;
+
+        case VERIFY_NONE:
+            required = 0;
+            break;
+
+        // Bernoulli sampling on a private generator, so that the generated tasksets do not depend on the policy
+        case VERIFY_SAMPLED:
+            required = (rand_r(&verification->seed) / (RAND_MAX * 1.0)) < verification->fraction;
+            break;
+
+        // Systematic sampling within each verdict: keep the number of cross-checked tasksets at ceil(fraction * seen)
+        // so that rare verdicts (e.g. NOT_SCHEDULABLE at low utilizations) are always represented
+        case VERIFY_STRATIFIED:
+            verification->num_seen[verdict]++;
+            required = verification->num_verified[verdict] < (int)(ceil(verification->fraction * verification->num_seen[verdict]));
+            break;
+
+        case VERIFY_BELOW_B:
+            required = schedulability_mcqpa->interval_length <= verification->b_limit;
+            break;
+
+        default:
+            assert(0 && "Unknown verification policy");
+    }
+
+    if (required)
+        verification->num_verified[verdict]++;
+
+    return required;
+}
+
+// Compare the verdict of the named test with the MC-QPA verdict, append a reproducer to MISMATCH_FILE if they differ. Return 1 on mismatch, else 0
+
+int check_verdicts (Verification *verification, const char *test_name, const Tasks *tasks, int num_tasks, Schedulability *schedulability, Schedulability *schedulability_mcqpa) {
+
+    // Experimentally confirms the correctness of MC-QPA
+    if (schedulability->taskset_schedulability == schedulability_mcqpa->taskset_schedulability)
+        return 0;
+
+    verification->num_mismatches++;
+
+    // Open the reproducer file on the first mismatch and reserve a fixed-width line for the number of tasksets
+    if (verification->mismatch_file == NULL) {
+        verification->mismatch_file = fopen(MISMATCH_FILE, "w+");
+        assert(verification->mismatch_file != NULL && "Error opening the reproducer file \"" MISMATCH_FILE "\"");
+        fprintf(verification->mismatch_file, "%10d\n", 0);
+    }
+
+    // Append the taskset in the input file format, wcets are printed with full precision to reproduce the exact verdicts
+    fprintf(verification->mismatch_file, "\n%d\n", num_tasks);
+    for (int i = 0; i < num_tasks; i++)
+        fprintf(verification->mismatch_file, "%d\t%d\t%d\t%.17g\t%.17g\n", tasks[i].period, tasks[i].deadline, tasks[i].criticality, tasks[i].wcet[LO], tasks[i].wcet[HI]);
+    fflush(verification->mismatch_file);
+
+    fprintf(stderr, " Mismatch %d: %s verdict %d, MC-QPA verdict %d, B %Lf (reproducer appended to \"%s\")\n", verification->num_mismatches, test_name, schedulability->taskset_schedulability, schedulability_mcqpa->taskset_schedulability, schedulability_mcqpa->interval_length, MISMATCH_FILE);
+
+    return 1;
+}
+
+// Finalize the reproducer file (if any) and release the verification state
+
+void close_verification (Verification *verification) {
+
+    if (verification->mismatch_file != NULL) {
+
+        // Overwrite the reserved first line with the number of tasksets written
+        fseek(verification->mismatch_file, 0, SEEK_SET);
+        fprintf(verification->mismatch_file, "%10d\n", verification->num_mismatches);
+        fclose(verification->mismatch_file);
+        verification->mismatch_file = NULL;
+    }
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../inc/auxiliary.h"
+#include "../inc/schedtest.h"
+#include "../inc/witness.h"
+
+// Witness-first MC-QPA: re-testing with the violation witnesses of similar tasksets
+//
+// Any (t, s) point with 0 <= s <= t at which the processor demand exceeds t proves that the taskset is NOT_SCHEDULABLE, whether or not
+// t <= B and s is in S(t). A witness found for a taskset thus remains a cheap candidate for slightly modified versions of it (scaled
+// wcets, perturbed periods, parameter sweeps): each candidate costs a single O(n) demand evaluation instead of a full MC-QPA descent.
+
+Schedulability* schedulability_test_witness (const Tasks *tasks, int num_tasks, const Witness *witnesses, int num_witnesses, Schedulability *schedulability, Workspace *workspace) {
+
+    double lo_util_sum = 0.0;                    // Sum of LO criticality utilizations of all tasks U_LO
+    double hi_util_sum = 0.0;                    // Sum of HI criticality utilizations of all tasks U_HI
+    double max_util_sum = 0.0;                   // Max {U_HI, U_LO}
+    double wcet_sum = 0.0;                       // Sum of wcets of all tasks at their own criticality level
+    long long int floor_t_upper_bound = 0;       // Floor of t upper bound B
+    double processor_demand = 0.0;               // Sum of DBFi(t, s) over all tasks at the candidate witness
+    int num_checked = 0;                         // Number of candidate witnesses checked
+
+    // Check the first EDF schedulability condition: Max{U_HI, U_LO} < 1.0 for the given taskset (MC-QPA reports the failure)
+    for (int i = 0; i < num_tasks; i++) {
+        lo_util_sum += tasks[i].utilization[LO];
+        hi_util_sum += tasks[i].utilization[HI];
+    }
+    max_util_sum = max(lo_util_sum, hi_util_sum);
+
+    // Check the candidate witnesses first
+    if (max_util_sum < 1.0) {
+
+        // Calculate floor B, only used to classify the failure
+        for (int i = 0; i < num_tasks; i++)
+            wcet_sum += tasks[i].wcet[(tasks[i].criticality)];
+        floor_t_upper_bound = (long long int)(floor(wcet_sum / (1.0 - max_util_sum)));
+
+        for (int w = 0; w < num_witnesses; w++) {
+
+            // Skip invalid candidates
+            if (witnesses[w].t <= 0 || witnesses[w].s < 0 || witnesses[w].s > witnesses[w].t)
+                continue;
+
+            processor_demand = get_processor_demand(tasks, num_tasks, witnesses[w].t, witnesses[w].s);
+            num_checked++;
+
+            // The candidate is a witness for this taskset too --> Taskset is NOT_SCHEDULABLE
+            if (processor_demand > witnesses[w].t) {
+                schedulability->taskset_schedulability = NOT_SCHEDULABLE;
+                schedulability->t_points = num_checked;
+                schedulability->t_s_points = num_checked;
+                schedulability->interval_length = floor_t_upper_bound;
+                schedulability->failed_case1 = (witnesses[w].t <= (0.5 * floor_t_upper_bound));
+                schedulability->failed_case2 = (witnesses[w].t <= (0.25 * floor_t_upper_bound));
+                schedulability->peak_memory = 0;
+                schedulability->approx_fallback = 0;
+                schedulability->witness = witnesses[w];
+                schedulability->witness.demand = processor_demand;
+                schedulability->witness_hit = 1;
+                schedulability->kernel = KERNEL_GENERIC;
+                schedulability->cached_t_points = 0;
+                return schedulability;
+            }
+        }
+    }
+
+    // No candidate rejects the taskset --> full MC-QPA descent, reporting the points checked by both
+    schedulability_test_mcqpa(tasks, num_tasks, schedulability, workspace);
+    schedulability->t_points += num_checked;
+    schedulability->t_s_points += num_checked;
+    schedulability->approx_fallback = 0;
+    schedulability->witness_hit = 0;
+
+    return schedulability;
+}
+
+// Initialize an empty witness pool
+
+void init_witness_pool (WitnessPool *witness_pool) {
+
+    witness_pool->num_witnesses = 0;
+    witness_pool->next = 0;
+}
+
+// Add the violation witness of a NOT_SCHEDULABLE test result to the pool (results without a witness and known witnesses are ignored)
+
+void add_witness (WitnessPool *witness_pool, const Schedulability *schedulability) {
+
+    if (WITNESS_POOL_SIZE == 0 || schedulability->taskset_schedulability != NOT_SCHEDULABLE || schedulability->witness.t <= 0)
+        return;
+
+    // Skip known witnesses
+    for (int w = 0; w < witness_pool->num_witnesses; w++)
+        if (witness_pool->witnesses[w].t == schedulability->witness.t && witness_pool->witnesses[w].s == schedulability->witness.s)
+            return;
+
+    // Append the witness, or overwrite the oldest one once the pool is full
+    witness_pool->witnesses[witness_pool->next] = schedulability->witness;
+    witness_pool->next++;
+    if (witness_pool->next == WITNESS_POOL_SIZE)
+        witness_pool->next = 0;
+    if (witness_pool->num_witnesses < WITNESS_POOL_SIZE)
+        witness_pool->num_witnesses++;
+}